@@ -0,0 +1,85 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host check of integer ballistics (low-level RMS against double recursion and speed)
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "ballistics.h"
+
+using namespace level_meter;
+
+static constexpr int32_t ZERO = 2048;  // raw code at zero input
+static constexpr double FREQ = 997.0;
+
+// calibrated sample (uint16_t: raw ADC code, int32_t: Q4 of ADC code by oversampling front end)
+static double _calib(const uint16_t raw) { return dsp::calib(raw, 1 << 16, -ZERO); }
+static double _calib(const int32_t raw) { return dsp::calib_hr(raw, 1 << 16, -ZERO) / static_cast<double>(1 << dsp::HR_FRAC); }
+
+// RMS of 997 Hz sine (1 sec) by integer ballistics and by double recursion on the same calibrated samples
+template <typename T>
+static int check_rms(const uint32_t sample_rate, const int amplitude, const double max_err_db)
+{
+    const int len = static_cast<int>(sample_rate);
+    const int scale = (sizeof(T) == sizeof(uint16_t)) ? 1 : (1 << dsp::HR_FRAC);
+    std::vector<T> raw(len);
+    for (int n = 0; n < len; n++) {
+        raw[n] = static_cast<T>(lround((ZERO + amplitude * sin(2.0 * M_PI * FREQ * n / sample_rate)) * scale));
+    }
+    const ballistics::coef_t coef = ballistics::get_coef(meter_mode_t::RMS, sample_rate);
+    ballistics b;
+    b.set_coef(coef);
+    b.process(raw.data(), 1, len, 1 << 16, -ZERO);
+
+    const double k = 1.0 - exp(-1.0 / (0.125 * sample_rate));
+    double ms = 0.0;
+    for (int n = 0; n < len; n++) {
+        const double x = _calib(raw[n]);
+        ms += (x * x - ms) * k;
+    }
+    const double ref = sqrt(ms);
+    const double val = b.get_value_q(16) / 65536.0;
+    const double err_db = (val > 0.0) ? 20.0 * log10(val / ref) : -INFINITY;
+    const bool pass = fabs(err_db) <= max_err_db;
+    printf("rms%s %6u Hz amplitude %4d: %8.3f (ref %8.3f) error %6.2f dB %s\n",
+        (scale == 1) ? "   " : "_hr", sample_rate, amplitude, val, ref, err_db, pass ? "OK" : "NG");
+    return pass ? 0 : 1;
+}
+
+static void bench_rms(const uint32_t sample_rate, const int num_loops)
+{
+    static uint16_t raw[1024];
+    for (int n = 0; n < 1024; n++) {
+        raw[n] = static_cast<uint16_t>(lround(ZERO + 1000 * sin(2.0 * M_PI * FREQ * n / sample_rate)));
+    }
+    ballistics b;
+    b.set_coef(ballistics::get_coef(meter_mode_t::RMS, sample_rate));
+    volatile int32_t sink = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_loops; i++) {
+        b.process(raw, 1, 1024, 1 << 16, -ZERO);
+        sink = sink + b.get_value();
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / num_loops;
+    printf("rms %6u Hz %9.1f ns/1024 samples, %6.2f ns/sample\n", sample_rate, ns, ns / 1024);
+}
+
+int main()
+{
+    int fail = 0;
+    for (const uint32_t rate : {500u, 8000u, 48000u}) {
+        for (const int amplitude : {10, 30, 100, 1000}) {
+            fail += check_rms<uint16_t>(rate, amplitude, 0.1);
+            fail += check_rms<int32_t>(rate, amplitude, 0.1);
+        }
+    }
+    bench_rms(48000, 20000);
+    return (fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host benchmark of fixed-point radix-4 FFT (accuracy against double DFT and speed)
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <random>
+
+#include "fft.h"
+
+using namespace level_meter;
+
+template <int N>
+static void bench(const int num_loops)
+{
+    static fft_radix4<N> fft;
+    static uint32_t x[N];
+    static std::complex<double> ref[N];
+    std::mt19937 rng(N);
+    std::uniform_int_distribution<int> dist(-16000, 16000);
+
+    // accuracy (output is scaled by 1/N)
+    for (int n = 0; n < N; n++) {
+        const int re = dist(rng);
+        const int im = dist(rng);
+        x[n] = dsp::pack(re, im);
+        ref[n] = {static_cast<double>(re), static_cast<double>(im)};
+    }
+    fft.forward(x);
+    double max_err = 0.0;
+    for (int k = 0; k < N; k++) {
+        std::complex<double> s = 0.0;
+        for (int n = 0; n < N; n++) {
+            s += ref[n] * std::polar(1.0, -2.0 * M_PI * k * n / N);
+        }
+        s /= N;
+        const double err = std::abs(s - std::complex<double>(dsp::lo(x[k]), dsp::hi(x[k])));
+        if (err > max_err) { max_err = err; }
+    }
+
+    // speed
+    volatile uint32_t sink = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_loops; i++) {
+        x[i % N] ^= 1;  // keep the loop from being optimized out
+        fft.forward(x);
+        sink = sink + x[1];
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / num_loops;
+    printf("fft%-5d max error %5.2f LSB, %9.1f ns/frame, %6.2f ns/point\n", N, max_err, ns, ns / N);
+}
+
+int main()
+{
+    bench<16>(200000);
+    bench<64>(100000);
+    bench<256>(20000);
+    bench<1024>(5000);
+    return 0;
+}
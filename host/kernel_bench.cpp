@@ -0,0 +1,371 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host microbenchmark of the kernels of block processing and drawing
+//   The kernels are the same headers / sources as the firmware. Each case is run for
+//   the minimum time after the calibration of the number of iterations, and repeated.
+//   The minimum and the median of the repetitions are reported (text or JSON).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "conv_dB_level.h"
+#include "dsp_util.h"
+#include "lcd_extra.h"
+#include "lcd_renderer.h"
+#include "level_meter.h"
+#include "meter_engine.h"
+#include "peak_hold.h"
+#include "stereo.h"
+#include "trimmed_mean.h"
+
+using namespace level_meter;
+
+static constexpr int BLOCK_LEN = BLOCK_FRAMES * NUM_ADC_CH;  // block of standard profile in level_meter.cpp
+static constexpr int NUM_INPUTS = 1024;  // blocks of random input (power of 2)
+
+typedef struct _result_t {
+    std::string name;
+    int items;             // items processed by an operation (samples, channels or segments)
+    uint64_t iterations;   // operations in a repetition
+    double ns_min;         // ns / operation
+    double ns_median;      // ns / operation
+} result_t;
+
+static double minTime = 0.2;  // sec per repetition
+static int numReps = 5;
+static std::string filter;
+static std::vector<result_t> results;
+static volatile uint32_t sink = 0;  // keep the results from being optimized out
+
+template <typename F>
+static double _run(F& func, const uint64_t n)
+{
+    uint32_t acc = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; i++) {
+        acc += func(static_cast<uint32_t>(i));
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    sink = sink + acc;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+/**
+* run a benchmark case
+*
+* @param[in] name the name of the case
+* @param[in] items the number of items processed by an operation
+* @param[in] func the operation uint32_t(uint32_t iteration), whose return value is accumulated
+*/
+template <typename F>
+static void bench(const std::string& name, const int items, F func)
+{
+    if (!filter.empty() && name.find(filter) == std::string::npos) { return; }
+    // calibrate the number of iterations to minTime
+    uint64_t n = 1;
+    double ns = _run(func, n);
+    while (ns < minTime * 1e8 && n < (1ull << 40)) {  // until 1/10 of minTime
+        n *= 2;
+        ns = _run(func, n);
+    }
+    n = std::max<uint64_t>(1, static_cast<uint64_t>(n * minTime * 1e9 / std::max(ns, 1.0)));
+    std::vector<double> reps;
+    for (int r = 0; r < numReps; r++) {
+        reps.push_back(_run(func, n) / n);
+    }
+    std::sort(reps.begin(), reps.end());
+    results.push_back({name, items, n, reps.front(), reps[reps.size() / 2]});
+}
+
+// ==========================
+// cases
+// ==========================
+static uint16_t rawInput[NUM_INPUTS][BLOCK_LEN];
+
+static void _prepare_input()
+{
+    // rectified signal around the zero level with noise
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(0, 4095);
+    std::normal_distribution<double> noise(0.0, 2.0);
+    for (int b = 0; b < NUM_INPUTS; b++) {
+        const int level = dist(rng);
+        for (int i = 0; i < BLOCK_LEN; i++) {
+            rawInput[b][i] = static_cast<uint16_t>(std::clamp(static_cast<int>(level + noise(rng)), 0, 4095));
+        }
+    }
+}
+
+template <int BUF_LEN>
+static void bench_trimmed_mean()
+{
+    using tm_t = trimmed_mean<BUF_LEN, NUM_ADC_CH>;
+    static uint16_t input[NUM_INPUTS][BUF_LEN];
+    for (int b = 0; b < NUM_INPUTS; b++) {
+        for (int i = 0; i < BUF_LEN; i++) {
+            input[b][i] = rawInput[(b + i / BLOCK_LEN) % NUM_INPUTS][i % BLOCK_LEN];
+        }
+    }
+    bench("trimmed_mean/" + std::to_string(BUF_LEN), BUF_LEN, [](const uint32_t it) {
+        uint32_t sum[NUM_ADC_CH];
+        tm_t::get_sum(input[it % NUM_INPUTS], sum);
+        return sum[0] + sum[NUM_ADC_CH - 1];
+    });
+}
+
+static void bench_calib()
+{
+    static constexpr int32_t GAIN = 71234;  // Q16
+    static constexpr int32_t OFS = -8;
+    bench("calib/" + std::to_string(BLOCK_LEN), BLOCK_LEN, [](const uint32_t it) {
+        const uint16_t* raw = rawInput[it % NUM_INPUTS];
+        uint32_t acc = 0;
+        for (int i = 0; i < BLOCK_LEN; i++) {
+            acc += dsp::calib(raw[i], GAIN, OFS);
+        }
+        return acc;
+    });
+    bench("calib_hr/" + std::to_string(BLOCK_LEN), BLOCK_LEN, [](const uint32_t it) {
+        const uint16_t* raw = rawInput[it % NUM_INPUTS];
+        uint32_t acc = 0;
+        for (int i = 0; i < BLOCK_LEN; i++) {
+            acc += dsp::calib_hr(raw[i] << dsp::HR_FRAC, GAIN, OFS);
+        }
+        return acc;
+    });
+}
+
+// correlation, balance and mid/side of the first 2 channels (items: samples of the block as calib)
+static void bench_stereo()
+{
+    if constexpr (NUM_ADC_CH >= 2) {
+        static const int32_t gain[] = {71234, 71234};  // Q16 (ch0 and ch1)
+        static const int32_t ofs[] = {-8, -8};
+        static stereo st(NUM_ADC_CH, 4095);
+        st.set_sample_rate(DEFAULT_SAMPLE_RATE);
+        bench("stereo/" + std::to_string(BLOCK_LEN), BLOCK_LEN, [](const uint32_t it) {
+            st.process(rawInput[it % NUM_INPUTS], BLOCK_FRAMES, gain, ofs);
+            stereo_t v;
+            st.get(v);
+            return static_cast<uint32_t>(v.correlation * 1000.0f);
+        });
+    }
+}
+
+// dB scale of N steps from -50 dB to +10 dB
+template <int N>
+struct scale_t {
+    float db[N];
+    constexpr scale_t() : db()
+    {
+        for (int k = 0; k < N; k++) { db[k] = -50.0f + 60.0f * k / (N - 1); }
+    }
+};
+
+template <int N>
+static void bench_conv_dB_level()
+{
+    static constexpr scale_t<N> scale;
+    static conv_dB_level conv(NUM_ADC_CH, std::vector<float>(scale.db, scale.db + N));
+    static conv_dB_level_lut<N, ADC_BITS, RANGE_RATIO_NUM, RANGE_RATIO_DEN> lut(scale.db);
+    static float linear[NUM_INPUTS][NUM_ADC_CH];
+    for (int b = 0; b < NUM_INPUTS; b++) {
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            linear[b][i] = static_cast<float>(rawInput[b][i]) / 4095.0f;
+        }
+    }
+    const std::string steps = std::to_string(N);
+    bench("conv_dB_level/" + steps, NUM_ADC_CH, [](const uint32_t it) {
+        unsigned int level[NUM_ADC_CH];
+        conv.get_level(linear[it % NUM_INPUTS], level);
+        return level[0] + level[NUM_ADC_CH - 1];
+    });
+    bench("conv_dB_level_lut/" + steps, NUM_ADC_CH, [](const uint32_t it) {
+        const uint16_t* raw = rawInput[it % NUM_INPUTS];
+        return lut.get_level(raw[0]) + lut.get_level(raw[1]);
+    });
+    bench("threshold_level/" + steps, NUM_ADC_CH, [](const uint32_t it) {
+        const uint16_t* raw = rawInput[it % NUM_INPUTS];
+        const int32_t code0 = (raw[0] << 8) + (raw[2] & 0xff);  // Q8
+        const int32_t code1 = (raw[1] << 8) + (raw[3] & 0xff);
+        return threshold_level(code0, lut.threshold(), N) + threshold_level(code1, lut.threshold(), N);
+    });
+}
+
+static void bench_peak_hold()
+{
+    static peak_hold<NUM_ADC_CH> ph;
+    ph.set_hold_blocks(50);
+    static unsigned int level[NUM_INPUTS][NUM_ADC_CH];
+    for (int b = 0; b < NUM_INPUTS; b++) {
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            level[b][i] = rawInput[b][i] * 24 / 4096;
+        }
+    }
+    bench("peak_hold", NUM_ADC_CH, [](const uint32_t it) {
+        ph.process(level[it % NUM_INPUTS], it);
+        return static_cast<uint32_t>(ph.get(0) + ph.get(NUM_ADC_CH - 1));
+    });
+}
+
+template <int CH>
+static void bench_meter_engine()
+{
+    // a meter of CH channels through all the stages (the time per channel should not depend on CH)
+    //   meter_engine::process() is the block processing of level_meter without auto-ranging
+    using engine_t = meter_engine<CH, BLOCK_FRAMES, PICO_LEVEL_METER_OVERSAMPLE, ADC_BITS>;
+    static constexpr int N = 24;
+    static constexpr scale_t<N> scale;
+    static conv_dB_level_lut<N, ADC_BITS, RANGE_RATIO_NUM, RANGE_RATIO_DEN> lut(scale.db);
+    static engine_t engine(static_cast<float>(RANGE_RATIO_NUM) / RANGE_RATIO_DEN);
+    static uint16_t input[NUM_INPUTS][engine_t::RAW_LEN];
+    for (int b = 0; b < NUM_INPUTS; b++) {
+        // each channel takes a block of random input (the same statistics for any CH)
+        for (int f = 0; f < engine_t::RAW_LEN / CH; f++) {
+            for (int ch = 0; ch < CH; ch++) {
+                input[b][f * CH + ch] = rawInput[(b + ch * 7) % NUM_INPUTS][f % BLOCK_LEN];
+            }
+        }
+    }
+    engine.set_level_table(lut.table(), lut.threshold(), N);
+    engine.set_sample_rate(DEFAULT_SAMPLE_RATE, meter_mode_t::TRIMMED_MEAN);
+    const meter_mode_t modes[] = {meter_mode_t::TRIMMED_MEAN, meter_mode_t::VU};
+    const char* const names[] = {"trimmed_mean", "vu"};
+    for (int m = 0; m < 2; m++) {
+        const meter_mode_t mode = modes[m];
+        bench("meter_engine/" + std::string(names[m]) + "/" + std::to_string(CH), CH, [mode](const uint32_t it) {
+            int32_t code[CH];
+            unsigned int level[CH];
+            engine.process(input[it % NUM_INPUTS], it, mode, code, level);
+            return static_cast<uint32_t>(level[0] + engine.get_peak_hold(CH - 1));
+        });
+    }
+}
+
+static void bench_lcd()
+{
+    // meter bars of main.cpp (2 horizontal bars of 24 segments)
+    static constexpr int NUM_SEGMENTS = 24;
+    static lcd_renderer lcd(spi1, 9, 8, BLACK);
+    static int bar[NUM_ADC_CH];
+    static uint16_t colors[NUM_SEGMENTS];
+    LCD_SetRotation(3);
+    lcd.init();
+    for (int ch = 0; ch < NUM_ADC_CH; ch++) {
+        bar[ch] = lcd.add_bar(lcd_renderer::orientation_t::HORIZONTAL, 0, 4 + 64 * ch, 5, 8, 6, NUM_SEGMENTS);
+    }
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+        colors[i] = (i < 13) ? GREEN : (i < 19) ? BRRED : RED;
+    }
+    auto level = [](const uint32_t it, const int ch) { return static_cast<int>(rawInput[it % NUM_INPUTS][ch] * NUM_SEGMENTS / 4096); };
+    bench("lcd_set_bar", NUM_ADC_CH * NUM_SEGMENTS, [&](const uint32_t it) {
+        for (int ch = 0; ch < NUM_ADC_CH; ch++) {
+            lcd.set_bar(bar[ch], level(it, ch), level(it, ch) + 2, colors, DARKGRAY);
+        }
+        return 0u;
+    });
+    // including the rendering of rectangles and the transfer by the stand-ins of DMA and LCD
+    bench("lcd_set_bar_flush", NUM_ADC_CH * NUM_SEGMENTS, [&](const uint32_t it) {
+        for (int ch = 0; ch < NUM_ADC_CH; ch++) {
+            lcd.set_bar(bar[ch], level(it, ch), level(it, ch) + 2, colors, DARKGRAY);
+        }
+        lcd.flush();
+        while (lcd.busy()) { lcd.poll(); }
+        return lcd.get_num_bytes();
+    });
+}
+
+// ==========================
+// report
+// ==========================
+static void _print_text()
+{
+    printf("%-26s %8s %12s %12s %12s %12s\n", "case", "items", "iterations", "ns/op(min)", "ns/op(med)", "ns/item");
+    for (const auto& r : results) {
+        printf("%-26s %8d %12llu %12.2f %12.2f %12.3f\n", r.name.c_str(), r.items,
+            static_cast<unsigned long long>(r.iterations), r.ns_min, r.ns_median, r.ns_min / r.items);
+    }
+}
+
+static void _print_json()
+{
+    printf("{\n");
+    printf("  \"context\": {\"compiler\": \"%s\", \"build_type\": \"%s\", \"min_time\": %.3f, \"repetitions\": %d},\n",
+        __VERSION__, KERNEL_BENCH_BUILD_TYPE, minTime, numReps);
+    printf("  \"benchmarks\": [\n");
+    for (size_t k = 0; k < results.size(); k++) {
+        const auto& r = results[k];
+        printf("    {\"name\": \"%s\", \"items\": %d, \"iterations\": %llu, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, \"ns_per_item\": %.4f}%s\n",
+            r.name.c_str(), r.items, static_cast<unsigned long long>(r.iterations), r.ns_min, r.ns_median, r.ns_min / r.items,
+            (k + 1 < results.size()) ? "," : "");
+    }
+    printf("  ]\n");
+    printf("}\n");
+}
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options]\n", prog);
+    printf(" --json              print the results in JSON\n");
+    printf(" --filter <str>      run only the cases whose name contains the string\n");
+    printf(" --min-time <sec>    time of a repetition (default: 0.2)\n");
+    printf(" --repetitions <n>   the number of repetitions (default: 5)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--filter" && val != nullptr) {
+            filter = val;
+            i++;
+        } else if (arg == "--min-time" && val != nullptr) {
+            minTime = atof(val);
+            i++;
+        } else if (arg == "--repetitions" && val != nullptr) {
+            numReps = std::max(1, atoi(val));
+            i++;
+        } else {
+            usage(argv[0]);
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+
+    _prepare_input();
+    bench_trimmed_mean<BLOCK_LEN>();
+    bench_trimmed_mean<64 / NUM_ADC_CH * NUM_ADC_CH>();
+    bench_trimmed_mean<PICO_LEVEL_METER_LOW_LATENCY_FRAMES * NUM_ADC_CH>();  // block of low-latency profile
+    bench_trimmed_mean<level_meter::HIGH_ACCURACY_FRAMES * NUM_ADC_CH>();    // block of high-accuracy profile
+    bench_calib();
+    bench_stereo();
+    bench_conv_dB_level<11>();
+    bench_conv_dB_level<24>();
+    bench_conv_dB_level<64>();
+    bench_peak_hold();
+    bench_meter_engine<1>();
+    bench_meter_engine<2>();
+    bench_meter_engine<3>();
+    bench_meter_engine<4>();
+    bench_lcd();
+
+    if (json) {
+        _print_json();
+    } else {
+        _print_text();
+    }
+    return 0;
+}
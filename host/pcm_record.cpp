@@ -0,0 +1,210 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// recorder of raw PCM stream ('P' command) from serial into WAV
+//   The samples of ADC code are converted to signed 16 bit (mid-scale at 0), and the blocks missing
+//   in the stream are filled with mid-scale to keep the timing. The text between the frames is passed to stderr.
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "pcm_format.h"
+#include "wire_frame.h"
+
+using namespace level_meter;
+
+static volatile sig_atomic_t stopReq = 0;
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options] <output.wav>\n", prog);
+    printf(" --port <path>     serial device of the meter (default: stdin), 'P' is sent to start and stop the stream\n");
+    printf(" --seconds <sec>   recording time (default: until EOF or Ctrl-C)\n");
+    printf(" --no-fill         skip the missing blocks instead of filling them with mid-scale\n");
+}
+
+static bool _open_port(const std::string& path, int& fd)
+{
+    fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0) { return false; }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) { return false; }
+    cfmakeraw(&tio);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static void _put_u16(FILE* fp, const uint16_t v)
+{
+    fputc(v & 0xff, fp);
+    fputc(v >> 8, fp);
+}
+
+static void _put_u32(FILE* fp, const uint32_t v)
+{
+    _put_u16(fp, v & 0xffff);
+    _put_u16(fp, v >> 16);
+}
+
+// RIFF WAVE header of 16 bit PCM (sizes are patched at the end)
+static void _write_wav_header(FILE* fp, const int num_ch, const uint32_t rate, const uint32_t data_bytes)
+{
+    fseek(fp, 0, SEEK_SET);
+    fwrite("RIFF", 1, 4, fp);
+    _put_u32(fp, 36 + data_bytes);
+    fwrite("WAVEfmt ", 1, 8, fp);
+    _put_u32(fp, 16);
+    _put_u16(fp, 1);  // PCM
+    _put_u16(fp, static_cast<uint16_t>(num_ch));
+    _put_u32(fp, rate);
+    _put_u32(fp, rate * num_ch * 2);
+    _put_u16(fp, static_cast<uint16_t>(num_ch * 2));
+    _put_u16(fp, 16);
+    fwrite("data", 1, 4, fp);
+    _put_u32(fp, data_bytes);
+}
+
+int main(int argc, char* argv[])
+{
+    std::string port;
+    std::string outPath;
+    double seconds = 0.0;
+    bool fill = true;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--port" && val != nullptr) {
+            port = val;
+            i++;
+        } else if (arg == "--seconds" && val != nullptr) {
+            seconds = atof(val);
+            i++;
+        } else if (arg == "--no-fill") {
+            fill = false;
+        } else if (arg[0] != '-' && outPath.empty()) {
+            outPath = arg;
+        } else {
+            usage(argv[0]);
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+    if (outPath.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int fd = STDIN_FILENO;
+    if (!port.empty()) {
+        if (!_open_port(port, fd)) {
+            fprintf(stderr, "ERROR: failed to open %s\n", port.c_str());
+            return 1;
+        }
+        if (write(fd, "P", 1) != 1) {
+            fprintf(stderr, "ERROR: failed to start PCM stream\n");
+            return 1;
+        }
+    }
+    FILE* fp = fopen(outPath.c_str(), "wb");
+    if (fp == nullptr) {
+        fprintf(stderr, "ERROR: failed to open %s\n", outPath.c_str());
+        return 1;
+    }
+    signal(SIGINT, [](int) { stopReq = 1; });
+
+    wire_frame::decoder dec;
+    pcm::prefix_t first = {};
+    pcm::prefix_t last = {};
+    bool hasBlock = false;
+    int blockLen = 0;  // samples of all channels
+    uint32_t numBlocks = 0;
+    uint32_t numMissing = 0;
+    uint32_t numInvalid = 0;
+    uint32_t dataBytes = 0;
+    std::vector<int16_t> pcm;
+    const auto t0 = std::chrono::steady_clock::now();
+    while (!stopReq) {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (seconds > 0.0 && elapsed >= seconds) { break; }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) { continue; }
+        uint8_t buf[4096];
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) { break; }  // EOF
+        for (ssize_t k = 0; k < n; k++) {
+            bool isText;
+            if (!dec.push(buf[k], isText)) {
+                if (isText) { fputc(buf[k], stderr); }
+                continue;
+            }
+            if (dec.type() != pcm::FRAME_PCM) { continue; }  // frames of trace or telemetry
+            pcm::prefix_t p;
+            if (!pcm::decode_prefix(dec.payload(), dec.len(), p)) {
+                numInvalid++;
+                continue;
+            }
+            const int len = (dec.len() - pcm::PREFIX_LEN) / 2;
+            if (!hasBlock) {
+                first = p;
+                blockLen = len;
+                _write_wav_header(fp, p.num_ch, p.sample_rate / p.num_ch, 0);
+                hasBlock = true;
+            } else if (p.num_ch != first.num_ch || p.sample_rate != first.sample_rate || len != blockLen) {
+                numInvalid++;  // the capture has been reconfigured
+                continue;
+            } else {
+                const uint32_t gap = p.seq - last.seq - 1;
+                numMissing += gap;
+                if (fill && gap > 0) {
+                    pcm.assign(static_cast<size_t>(blockLen) * gap, 0);
+                    fwrite(pcm.data(), sizeof(int16_t), pcm.size(), fp);
+                    dataBytes += pcm.size() * sizeof(int16_t);
+                }
+            }
+            last = p;
+            const uint8_t* s = dec.payload() + pcm::PREFIX_LEN;
+            const int mid = 1 << (p.bits - 1);
+            pcm.resize(len);
+            for (int i = 0; i < len; i++) {
+                const int code = s[i * 2] | (s[i * 2 + 1] << 8);
+                pcm[i] = static_cast<int16_t>((code - mid) << (16 - p.bits));
+            }
+            fwrite(pcm.data(), sizeof(int16_t), pcm.size(), fp);
+            dataBytes += pcm.size() * sizeof(int16_t);
+            numBlocks++;
+        }
+    }
+    if (!port.empty()) {
+        if (write(fd, "P", 1) != 1) {
+            fprintf(stderr, "ERROR: failed to stop PCM stream\n");
+        }
+        close(fd);
+    }
+    if (hasBlock) {
+        _write_wav_header(fp, first.num_ch, first.sample_rate / first.num_ch, dataBytes);
+    }
+    fclose(fp);
+
+    fprintf(stderr, "\n[PCM record]\n");
+    if (!hasBlock) {
+        fprintf(stderr, " %s: no blocks, %u frame errors\n", outPath.c_str(), dec.get_num_errors());
+        return 1;
+    }
+    const uint32_t rate = first.sample_rate / first.num_ch;
+    fprintf(stderr, " %s: %u Hz x %d ch, %d bit, %.3f sec\n", outPath.c_str(), rate, first.num_ch, first.bits,
+        static_cast<double>(dataBytes) / (2.0 * first.num_ch * rate));
+    fprintf(stderr, " blocks: %u received (seq %u - %u), %u missing (overruns by device: %u), %u invalid frames, %u frame errors\n",
+        numBlocks, first.seq, last.seq, numMissing, last.num_overruns - first.num_overruns, numInvalid, dec.get_num_errors());
+    fprintf(stderr, " result: %s\n", (numMissing > 0 || dec.get_num_errors() > 0) ? "NOT lossless" : "lossless");
+    return 0;
+}
@@ -0,0 +1,50 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator stand-in of pico_flash_param (parameters are kept in a text file given to the simulator)
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace FlashParamNs {
+
+static constexpr uint32_t CFG_ID_BASE = 0x100;
+
+class ParamBase
+{
+public:
+    ParamBase(const uint32_t id, const char* name);
+    virtual ~ParamBase() = default;
+    const char* name() const { return _name; }
+    virtual int64_t get_raw() const = 0;
+    virtual void set_raw(const int64_t value) = 0;
+protected:
+    const uint32_t _id;
+    const char* _name;
+};
+
+template <typename T>
+class Parameter : public ParamBase
+{
+public:
+    Parameter(const uint32_t id, const char* name, const T& default_value, const size_t size = sizeof(T)) :
+        ParamBase(id, name), _value(default_value) { (void) size; }
+    T get() const { return _value; }
+    void set(const T& value) { _value = value; }
+    int64_t get_raw() const override { return static_cast<int64_t>(_value); }
+    void set_raw(const int64_t value) override { _value = static_cast<T>(value); }
+protected:
+    T _value;
+};
+
+struct FlashParam {
+    void initialize();  // load the parameters from the file
+    bool finalize();    // store the parameters to the file
+};
+
+}
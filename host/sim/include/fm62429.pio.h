@@ -0,0 +1,15 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator stand-in of the header generated from fm62429.pio
+
+#pragma once
+
+#include "hardware/pio.h"
+
+extern const pio_program_t fm62429_program;
+
+static inline void fm62429_program_init(PIO, uint, uint, uint, uint, float) {}
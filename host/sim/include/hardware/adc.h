@@ -0,0 +1,11 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+void adc_gpio_init(const uint gpio);
@@ -0,0 +1,17 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+enum clock_num {
+    clk_sys = 0,
+    clk_adc
+};
+typedef enum clock_num clock_handle_t;
+
+uint32_t clock_get_hz(const clock_handle_t clk);
@@ -0,0 +1,31 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+// DMA stand-in for memory to SPI transfers (done at trigger)
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+int dma_claim_unused_channel(const bool required);
+dma_channel_config dma_channel_get_default_config(const uint channel);
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c, const enum dma_channel_transfer_size size) { c->ctrl = size; }
+static inline void channel_config_set_read_increment(dma_channel_config*, const bool) {}
+static inline void channel_config_set_write_increment(dma_channel_config*, const bool) {}
+static inline void channel_config_set_dreq(dma_channel_config*, const uint) {}
+void dma_channel_configure(const uint channel, const dma_channel_config* config, volatile void* write_addr, const volatile void* read_addr, const uint transfer_count, const bool trigger);
+void dma_channel_set_read_addr(const uint channel, const volatile void* read_addr, const bool trigger);
+void dma_channel_set_trans_count(const uint channel, const uint32_t trans_count, const bool trigger);
+bool dma_channel_is_busy(const uint channel);
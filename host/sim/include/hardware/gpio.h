@@ -0,0 +1,19 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+typedef unsigned int uint;
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+void gpio_init(const uint gpio);
+void gpio_set_dir(const uint gpio, const bool out);
+void gpio_put(const uint gpio, const bool value);
+bool gpio_is_forced_low(const uint gpio);  // simulator: output low
@@ -0,0 +1,32 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef void (*irq_handler_t)();
+
+// IRQ numbers of RP2350
+#define DMA_IRQ_0 10
+#define DMA_IRQ_1 11
+#define PIO0_IRQ_0 15
+#define FIRST_USER_IRQ 46
+#define NUM_USER_IRQS 6
+#define NUM_IRQS 52
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+#define PICO_LOWEST_IRQ_PRIORITY 0xff
+
+void irq_set_exclusive_handler(const uint num, irq_handler_t handler);
+void irq_add_shared_handler(const uint num, irq_handler_t handler, const uint8_t order_priority);
+bool irq_has_shared_handler(const uint num);
+void irq_set_priority(const uint num, const uint8_t priority);
+void irq_set_enabled(const uint num, const bool enabled);
+void irq_set_pending(const uint num);
+int user_irq_claim_unused(const bool required);
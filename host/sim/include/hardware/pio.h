@@ -0,0 +1,37 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+
+// PIO stand-in: a word put to TX FIFO is taken as an FM62429 frame, which ends
+//   after the frame time of the PIO program and raises the state machine IRQ
+typedef struct pio_hw {
+    uint32_t irq;  // IRQ flags of state machines
+} pio_hw_t;
+typedef pio_hw_t* PIO;
+
+extern PIO const pio0;
+
+typedef struct {
+    const uint16_t* instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+typedef enum pio_interrupt_source {
+    pis_interrupt0 = 8
+} pio_interrupt_source_t;
+
+uint pio_claim_unused_sm(PIO pio, const bool required);
+uint pio_add_program(PIO pio, const pio_program_t* program);
+static inline uint pio_get_irq_num(PIO, const uint irqn) { return PIO0_IRQ_0 + irqn; }
+void pio_set_irq0_source_enabled(PIO pio, const pio_interrupt_source_t source, const bool enabled);
+static inline bool pio_interrupt_get(PIO pio, const uint num) { return (pio->irq >> num) & 1u; }
+static inline void pio_interrupt_clear(PIO pio, const uint num) { pio->irq &= ~(1u << num); }
+void pio_sm_put(PIO pio, const uint sm, const uint32_t data);
@@ -0,0 +1,27 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define SPI_SSPICR_RORIC_BITS 0x00000001
+
+typedef struct {
+    volatile uint32_t dr;   // pixels written by DMA go to the LCD stand-in
+    volatile uint32_t icr;
+} spi_hw_t;
+
+typedef struct spi_inst {
+    spi_hw_t hw;
+} spi_inst_t;
+
+extern spi_inst_t* const spi1;
+
+static inline spi_hw_t* spi_get_hw(spi_inst_t* spi) { return &spi->hw; }
+static inline uint spi_get_dreq(spi_inst_t*, const bool) { return 0; }
+static inline bool spi_is_readable(spi_inst_t*) { return false; }
+static inline bool spi_is_busy(spi_inst_t*) { return false; }
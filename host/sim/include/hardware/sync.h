@@ -0,0 +1,17 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+// interrupts of the simulated core (pending IRQs run at restore)
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(const uint32_t status);
+
+// event register of the simulated core (set by SEV and interrupts, WFE sleeps until it is set)
+void __sev();
+void __wfe();
@@ -0,0 +1,68 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator stand-in of pico_st7735_80x160 (drawing to an in-memory framebuffer)
+
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+#define WHITE    0xFFFF
+#define BLACK    0x0000
+#define RED      0xF800
+#define GREEN    0x07E0
+#define BRRED    0xFC07
+#define GRAY     0x8430
+#define DARKGRAY 0x4208
+
+#define SPI_CLK_FREQ_DEFAULT 50000000
+#define PIN_LCD_SPI1_CS_WAVESHARE   9
+#define PIN_LCD_SPI1_SCK_WAVESHARE  10
+#define PIN_LCD_SPI1_MOSI_WAVESHARE 11
+#define PIN_LCD_DC_WAVESHARE        8
+#define PIN_LCD_RST_WAVESHARE       12
+#define PIN_LCD_BLK_WAVESHARE       25
+#define PWM_BLK_DEFAULT    255
+#define INVERSION_DEFAULT  1
+#define RGB_ORDER_DEFAULT  1
+#define ROTATION_DEFAULT   0
+#define H_OFS_DEFAULT      26
+#define V_OFS_DEFAULT      1
+#define X_MIRROR_DEFAULT   0
+
+typedef struct {
+    uint32_t spi_clk_freq;
+    spi_inst_t* spi_inst;
+    uint pin_cs;
+    uint pin_sck;
+    uint pin_mosi;
+    uint pin_dc;
+    uint pin_rst;
+    uint pin_blk;
+    uint pwm_blk;
+    uint8_t inversion;
+    uint8_t rgb_order;
+    uint8_t rotation;
+    uint16_t h_ofs;
+    uint16_t v_ofs;
+    uint8_t x_mirror;
+} pico_st7735_80x160_config_t;
+
+extern u16 BACK_COLOR;
+
+void LCD_Config(const pico_st7735_80x160_config_t* config);
+void LCD_Init();
+void LCD_SetRotation(const u8 rotation);
+u16 LCD_W();
+u16 LCD_H();
+void LCD_Clear(const u16 color);
+void LCD_Address_Set(const u16 x1, const u16 y1, const u16 x2, const u16 y2);
+void LCD_ShowString(const u16 x, const u16 y, const u8* p, const u16 color);
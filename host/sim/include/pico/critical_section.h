@@ -0,0 +1,17 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    uint32_t save;
+} critical_section_t;
+
+void critical_section_init(critical_section_t* crit_sec);
+void critical_section_enter_blocking(critical_section_t* crit_sec);
+void critical_section_exit(critical_section_t* crit_sec);
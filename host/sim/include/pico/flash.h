@@ -0,0 +1,13 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+// flash access is simulated as interrupts disabled for the flash time given to the simulator
+int flash_safe_execute(void (*func)(void*), void* param, const uint32_t enter_exit_timeout_ms);
+static inline bool flash_safe_execute_core_init() { return true; }
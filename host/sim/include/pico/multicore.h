@@ -0,0 +1,10 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+// single core simulator (PICO_LEVEL_METER_CORE1 is not supported)
+#include "pico/stdlib.h"
@@ -0,0 +1,44 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator stand-in of pico-sdk (subset used by pico_level_meter)
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "hardware/gpio.h"
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define __time_critical_func(func_name) func_name
+#define __not_in_flash_func(func_name) func_name
+#define __isr
+
+enum pico_error_codes {
+    PICO_OK = 0,
+    PICO_ERROR_TIMEOUT = -1
+};
+
+// time (simulated, advanced by the simulator)
+uint64_t time_us_64();
+static inline absolute_time_t get_absolute_time() { return time_us_64(); }
+static inline uint32_t to_ms_since_boot(const absolute_time_t t) { return static_cast<uint32_t>(t / 1000); }
+static inline absolute_time_t from_us_since_boot(const uint64_t us) { return us; }
+void sleep_ms(const uint32_t ms);
+void sleep_us(const uint64_t us);
+void tight_loop_contents();  // advances simulated time by 1 us
+static inline void __wfi() { tight_loop_contents(); }
+bool best_effort_wfe_or_timeout(const absolute_time_t timeout_timestamp);  // true at timeout
+
+// stdio (printf goes to stdout, input is given by the simulator)
+bool stdio_init_all();
+bool stdio_usb_connected();
+int getchar_timeout_us(const uint32_t timeout_us);
+void stdio_set_chars_available_callback(void (*fn)(void*), void* param);  // called at the time of each key
+int stdio_put_string(const char* s, int len, bool newline, bool cr_translation);
@@ -0,0 +1,14 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator stand-in of TinyUSB (subset used by pico_level_meter)
+
+#pragma once
+
+#include <cstdint>
+
+// room of USB CDC transmit FIFO (stdout of the simulator is never full)
+uint32_t tud_cdc_write_available();
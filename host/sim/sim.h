@@ -0,0 +1,72 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+* host simulator of pico_level_meter
+*
+* The application (main.cpp) and the library run on a single simulated core against
+* stand-ins of pico-sdk. Time is simulated: it advances to the next event (ADC capture, key
+* or timeout) while the main loop sleeps by WFE, so the simulation runs
+* as fast as the host allows. Interrupts are dispatched in the order of priority at the event
+* which raises them, and set the event register as well as SEV.
+*/
+namespace sim
+{
+    typedef struct _options_t {
+        std::string source = "sine:997:-6";  // signal source (see sim_signal.cpp)
+        std::vector<std::pair<double, double>> gain_steps;  // (time in sec, gain in dB) applied to the source
+        double seconds = 0.0;          // simulated duration (0: length of the source, 10 sec for synthetic ones)
+        uint32_t sample_rate = 0;      // sampling rate per channel (0: default of level meter)
+        double adc_offset = 8.0;       // ADC code at zero input
+        double adc_noise = 0.5;        // ADC noise in LSB rms
+        uint32_t flash_ms = 50;        // time of flash erase and program at settings save
+        uint32_t cdc_rate = 1000000;   // bytes per second taken by host from USB CDC transmit FIFO
+        std::string flash_file;        // file of parameters stored by FlashParam (empty: not persisted)
+        std::string ppm_file;          // framebuffer of LCD at the end (empty: not written)
+        std::vector<std::pair<double, char>> keys;  // (time in sec, character) to stdio
+    } options_t;
+
+    extern options_t options;
+
+    // simulated time
+    uint64_t now_ns();
+    void advance_to(const uint64_t t_ns);
+    bool wait_event(const uint64_t t_ns);  // advance until the event register is set or the time (true at the time)
+    void set_duration(const double seconds);  // finish() at the time
+
+    // interrupts
+    void raise_irq(const unsigned int num);
+    bool in_irq();
+
+    // analog front end (FM62429 attenuation and ADC input)
+    void set_attenuation(const int ch, const int db);
+    int get_attenuation(const int ch);
+    uint16_t adc_sample(const int ch, const double t);
+
+    // signal source
+    bool source_open(const std::string& spec, double& duration);
+    float source_sample(const int ch, const double t);
+
+    // ADC capture stand-in
+    uint64_t adc_next_event_ns();  // UINT64_MAX if not running
+    void adc_event();
+    void adc_fill();               // capture the samples up to now (before the analog front end changes)
+    void adc_report(const double wall_sec);
+
+    // LCD stand-in
+    void lcd_write(const uint8_t* data, const uint32_t len);
+    void lcd_report();
+    bool lcd_write_ppm(const std::string& path);
+
+    // print the report and exit
+    [[noreturn]] void finish();
+}
@@ -0,0 +1,244 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator: stand-in of adc_capture fed by the analog front end model
+//   The samples are written into the ring at their simulated time, and DMA IRQ is raised
+//   at the end of each block. The IRQ handler is the same as the one on hardware
+//   (lost blocks are counted when the ring is overrun while interrupts are disabled).
+//   The block being written is seen only modulo the length of the DMA block address table
+//   and extended by the simulated microsecond timer as on hardware.
+
+#include "adc_capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "level_meter.h"  // PICO_LEVEL_METER_DMA_IRQ
+#include "seq_extender.h"
+#include "sim.h"
+
+namespace level_meter
+{
+namespace adc_capture
+{
+
+#define DMA_IRQ_x (DMA_IRQ_0 + PICO_LEVEL_METER_DMA_IRQ)
+
+static uint16_t* ring_buf = nullptr;
+static int       blockLen;
+static int       numBlocks;
+static int       chList[4];
+static int       numCh;
+static block_handler_t blockHandler = nullptr;
+
+static uint32_t sampleRate = SAMPLE_RATE_MAX;
+static bool     running = false;
+static uint64_t startNs;         // time of the first sample after start()
+static uint64_t startSample;     // sample index at start()
+static uint64_t numWritten = 0;  // samples written into the ring
+static uint32_t seq = 0;         // sequence number of the next block to handle
+static uint32_t numLost = 0;
+
+// block address table of DMA (SEQ_TABLE_LEN of adc_capture.cpp)
+static constexpr int SEQ_TABLE_LEN = 256;
+static seq_extender<SEQ_TABLE_LEN> writeSeq;
+
+// per-block latency of block handler in wall clock
+static uint64_t numHandled = 0;
+static double latSum = 0.0;
+static double latMin = 1e9;
+static double latMax = 0.0;
+static uint64_t numOverruns = 0;  // blocks whose handling took longer than the block period
+
+static void _dma_irq_handler();
+
+static inline uint64_t _sample_ns(const uint64_t n)
+{
+    return startNs + (n - startSample) * 1000000000ull / sampleRate;
+}
+
+static inline uint32_t _now_us()
+{
+    return static_cast<uint32_t>(sim::now_ns() / 1000);
+}
+
+static inline uint32_t _table_idx()
+{
+    // table index of the block being written
+    return static_cast<uint32_t>(numWritten / blockLen) & (SEQ_TABLE_LEN - 1);
+}
+
+void init(const uint32_t ch_mask, uint16_t* buf, const int block_len, const int num_blocks, block_handler_t handler)
+{
+    ring_buf = buf;
+    blockLen = block_len;
+    numBlocks = num_blocks;
+    blockHandler = handler;
+    numCh = 0;
+    for (int i = 0; i < 4; i++) {
+        if (ch_mask & (1u << i)) { chList[numCh++] = i; }
+    }
+    writeSeq.set_rate(blockLen, sampleRate);
+}
+
+void irq_init()
+{
+    if (!irq_has_shared_handler(DMA_IRQ_x)) {
+        irq_add_shared_handler(DMA_IRQ_x, _dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    }
+    irq_set_enabled(DMA_IRQ_x, true);
+}
+
+void set_sample_rate(const uint32_t rate)
+{
+    sampleRate = (rate == 0) ? 1 : (rate > SAMPLE_RATE_MAX) ? SAMPLE_RATE_MAX : rate;
+    writeSeq.set_rate(blockLen, sampleRate);
+}
+
+uint32_t get_sample_rate()
+{
+    return sampleRate;
+}
+
+void start()
+{
+    // from the top of the next block (the block in progress has been discarded by stop())
+    numWritten = (numWritten + blockLen - 1) / blockLen * blockLen;
+    seq = static_cast<uint32_t>(numWritten / blockLen);
+    startSample = numWritten;
+    startNs = sim::now_ns();
+    running = true;
+    writeSeq.start(seq, _now_us());
+}
+
+void stop()
+{
+    sim::adc_fill();
+    running = false;
+    writeSeq.stop(_table_idx(), _now_us());
+}
+
+uint32_t get_num_lost()
+{
+    return numLost;
+}
+
+uint32_t get_num_unhandled()
+{
+    sim::adc_fill();
+    return writeSeq.get(_table_idx(), _now_us()) - seq;
+}
+
+uint32_t get_position()
+{
+    sim::adc_fill();
+    return writeSeq.get(_table_idx(), _now_us()) * blockLen + static_cast<uint32_t>(numWritten % blockLen);
+}
+
+uint32_t get_write_seq()
+{
+    sim::adc_fill();
+    return writeSeq.get(_table_idx(), _now_us());
+}
+
+static void _dma_irq_handler()
+{
+    sim::adc_fill();  // the table index is live on hardware
+    const uint32_t wr = writeSeq.update(_table_idx(), _now_us());
+    uint32_t numReady = wr - seq;
+    if (numReady > static_cast<uint32_t>(numBlocks - 1)) {
+        const uint32_t n = numReady - (numBlocks - 1);
+        numLost += n;
+        seq += n;
+        numReady -= n;
+    }
+    const double periodUs = 1e6 * blockLen / sampleRate;
+    while (numReady > 0) {
+        const auto t0 = std::chrono::steady_clock::now();
+        blockHandler(&ring_buf[(seq & (numBlocks - 1)) * blockLen], seq);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        numHandled++;
+        latSum += us;
+        latMin = std::min(latMin, us);
+        latMax = std::max(latMax, us);
+        if (us > periodUs) { numOverruns++; }
+        seq++;
+        numReady--;
+    }
+}
+
+}
+}
+
+namespace sim
+{
+
+using namespace level_meter::adc_capture;
+
+static constexpr int PIN_ADC_BASE = 26;
+static constexpr double FULL_SCALE_CODE = 4095.0 * level_meter::RANGE_RATIO_NUM / level_meter::RANGE_RATIO_DEN;
+
+uint64_t adc_next_event_ns()
+{
+    if (!running) { return UINT64_MAX; }
+    const uint64_t next = (numWritten / blockLen + 1) * blockLen;  // end of the block in progress
+    return _sample_ns(next);
+}
+
+void adc_fill()
+{
+    if (!running) { return; }
+    const uint64_t now = now_ns();
+    const uint64_t ringLen = static_cast<uint64_t>(blockLen) * numBlocks;
+    while (_sample_ns(numWritten) < now) {
+        const int ch = chList[numWritten % numCh];
+        const double t = static_cast<double>(_sample_ns(numWritten)) * 1e-9;
+        ring_buf[numWritten % ringLen] = adc_sample(ch, t);
+        numWritten++;
+    }
+}
+
+void adc_event()
+{
+    adc_fill();
+    raise_irq(DMA_IRQ_x);
+}
+
+uint16_t adc_sample(const int ch, const double t)
+{
+    // full-wave rectified input (0 dBFS at the top of the dB scale) through the attenuator
+    double v = options.adc_offset;
+    if (!gpio_is_forced_low(PIN_ADC_BASE + ch)) {
+        v += std::fabs(source_sample(ch, t)) * std::pow(10.0, get_attenuation(ch) / 20.0) * FULL_SCALE_CODE;
+    }
+    if (options.adc_noise > 0.0) {
+        // Box-Muller
+        static uint64_t s = 0x9e3779b97f4a7c15ull;
+        auto uni = [&]() {
+            s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+            return (static_cast<double>(s >> 11) + 0.5) / 9007199254740992.0;
+        };
+        v += options.adc_noise * std::sqrt(-2.0 * std::log(uni())) * std::cos(2.0 * M_PI * uni());
+    }
+    const long code = std::lround(v);
+    return static_cast<uint16_t>(std::clamp(code, 0L, 4095L));
+}
+
+void adc_report(const double wall_sec)
+{
+    const double simSec = now_ns() * 1e-9;
+    printf(" simulated: %.3f sec, wall: %.3f sec, real-time factor: %.1f\r\n", simSec, wall_sec, (wall_sec > 0.0) ? simSec / wall_sec : 0.0);
+    printf(" blocks: %llu handled, %u lost\r\n", static_cast<unsigned long long>(numHandled), numLost);
+    if (numHandled > 0) {
+        printf(" per-block latency: min %.2f us, ave %.2f us, max %.2f us (block period %.1f us, %llu over)\r\n",
+            latMin, latSum / numHandled, latMax, 1e6 * blockLen / sampleRate, static_cast<unsigned long long>(numOverruns));
+    }
+}
+
+}
@@ -0,0 +1,571 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator: stand-ins of time, IRQ, GPIO, stdio, PIO (FM62429), DMA to SPI and flash
+
+#include "sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "pico/flash.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/spi.h"
+#include "hardware/sync.h"
+#include "FlashParam.h"
+#include "fm62429.pio.h"
+#include "tusb.h"
+
+namespace sim
+{
+
+options_t options;
+
+static uint64_t simNs = 0;
+static uint64_t endNs = UINT64_MAX;
+static const auto wallStart = std::chrono::steady_clock::now();
+
+//=================================
+// interrupts
+//=================================
+typedef struct _irq_t {
+    std::vector<irq_handler_t> handlers;
+    uint8_t priority = PICO_DEFAULT_IRQ_PRIORITY;
+    bool enabled = false;
+    bool pending = false;
+} irq_t;
+
+static irq_t irqs[NUM_IRQS];
+static uint32_t irqMask = 0;  // nesting count of disabled interrupts
+static bool inIrq = false;
+static bool eventReg = false;  // event register of WFE
+
+static void _dispatch()
+{
+    // no nesting: a raised IRQ runs after the current handler returns
+    if (inIrq || irqMask > 0) { return; }
+    while (true) {
+        int num = -1;
+        for (int i = 0; i < NUM_IRQS; i++) {
+            if (irqs[i].pending && irqs[i].enabled && (num < 0 || irqs[i].priority < irqs[num].priority)) {
+                num = i;
+            }
+        }
+        if (num < 0) { return; }
+        irqs[num].pending = false;
+        inIrq = true;
+        for (irq_handler_t handler : irqs[num].handlers) {
+            handler();
+        }
+        inIrq = false;
+        eventReg = true;  // a taken interrupt wakes WFE
+    }
+}
+
+void raise_irq(const unsigned int num)
+{
+    irqs[num].pending = true;
+    _dispatch();
+}
+
+bool in_irq()
+{
+    return inIrq;
+}
+
+//=================================
+// PIO (FM62429 frames)
+//=================================
+static constexpr uint64_t FM62429_FRAME_NS = 51 * 10000;  // 51 instructions of 10 us (fm62429.pio)
+static std::deque<uint32_t> pioTxFifo;
+static uint64_t pioDoneNs = UINT64_MAX;  // end of the frame being sent
+static int attDb[2] = {0, 0};
+
+void set_attenuation(const int ch, const int db)
+{
+    adc_fill();  // the samples before the change
+    attDb[ch] = db;
+}
+
+int get_attenuation(const int ch)
+{
+    return (ch < 2) ? attDb[ch] : 0;  // the attenuator is in front of ch0 and ch1
+}
+
+static void _pio_frame_done()
+{
+    // the word is inverted by the external MOSFET
+    const uint32_t code = ~pioTxFifo.front() & 0x7ff;
+    pioTxFifo.pop_front();
+    // D8 ~ D2: attenuation code (see fm62429::get_att_code), D1: 1 for each channel, D0: channel
+    const uint32_t att = (code >> 2) & 0x7f;
+    const int db = -(4 * (21 - static_cast<int>(att & 0x1f)) + (3 - static_cast<int>(att >> 5)));
+    if (code & 0b10) {
+        set_attenuation(code & 0b1, db);
+    } else {
+        set_attenuation(0, db);
+        set_attenuation(1, db);
+    }
+    pioDoneNs = pioTxFifo.empty() ? UINT64_MAX : simNs + FM62429_FRAME_NS;
+    pio0->irq |= 1u;  // irq 0 rel of state machine 0
+    raise_irq(PIO0_IRQ_0);
+}
+
+//=================================
+// time
+//=================================
+uint64_t now_ns()
+{
+    return simNs;
+}
+
+static uint64_t _next_key_ns();
+static void _key_event();
+
+static void _advance(const uint64_t t_ns, const bool until_event)
+{
+    while (simNs < t_ns && !(until_event && eventReg)) {
+        const uint64_t adcNs = adc_next_event_ns();
+        const uint64_t keyNs = _next_key_ns();
+        const uint64_t next = std::min({t_ns, adcNs, pioDoneNs, keyNs, endNs});
+        simNs = next;
+        if (next == pioDoneNs) {
+            _pio_frame_done();
+        }
+        if (next == adcNs) {
+            adc_event();
+        }
+        if (next == keyNs) {
+            _key_event();
+        }
+        if (next == endNs) {
+            finish();
+        }
+    }
+}
+
+void advance_to(const uint64_t t_ns)
+{
+    _advance(t_ns, false);
+}
+
+bool wait_event(const uint64_t t_ns)
+{
+    _advance(t_ns, true);
+    eventReg = false;
+    return simNs >= t_ns;
+}
+
+void set_duration(const double seconds)
+{
+    endNs = static_cast<uint64_t>(seconds * 1e9);
+}
+
+[[noreturn]] void finish()
+{
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printf("\r\n[Simulation report]\r\n");
+    adc_report(wall);
+    printf(" attenuation L: %d dB, R: %d dB\r\n", attDb[0], attDb[1]);
+    lcd_report();
+    if (!options.ppm_file.empty() && !lcd_write_ppm(options.ppm_file)) {
+        printf("ERROR: failed to write %s\r\n", options.ppm_file.c_str());
+    }
+    fflush(stdout);
+    exit(0);
+}
+
+//=================================
+// stdio
+//=================================
+static size_t keyIdx = 0;
+static size_t keyNotifyIdx = 0;  // keys notified by chars available callback
+static void (*charsAvailable)(void*) = nullptr;
+static void* charsAvailableParam = nullptr;
+
+static int _take_key()
+{
+    if (keyIdx < options.keys.size() && options.keys[keyIdx].first * 1e9 <= simNs) {
+        return static_cast<unsigned char>(options.keys[keyIdx++].second);
+    }
+    return PICO_ERROR_TIMEOUT;
+}
+
+static uint64_t _next_key_ns()
+{
+    if (charsAvailable == nullptr || keyNotifyIdx >= options.keys.size()) { return UINT64_MAX; }
+    return std::max(simNs, static_cast<uint64_t>(options.keys[keyNotifyIdx].first * 1e9));
+}
+
+static void _key_event()
+{
+    // chars available callback of USB stdio (from IRQ)
+    keyNotifyIdx++;
+    charsAvailable(charsAvailableParam);
+    eventReg = true;
+}
+
+}  // namespace sim
+
+using namespace sim;
+
+uint64_t time_us_64()
+{
+    return simNs / 1000;
+}
+
+void sleep_ms(const uint32_t ms)
+{
+    advance_to(simNs + static_cast<uint64_t>(ms) * 1000000);
+}
+
+void sleep_us(const uint64_t us)
+{
+    advance_to(simNs + us * 1000);
+}
+
+void tight_loop_contents()
+{
+    advance_to(simNs + 1000);
+}
+
+bool best_effort_wfe_or_timeout(const absolute_time_t timeout_timestamp)
+{
+    return wait_event(timeout_timestamp * 1000);
+}
+
+void __sev()
+{
+    eventReg = true;
+}
+
+void __wfe()
+{
+    wait_event(UINT64_MAX);
+}
+
+bool stdio_init_all()
+{
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+    return true;
+}
+
+bool stdio_usb_connected()
+{
+    return true;
+}
+
+// USB CDC transmit FIFO taken by host at options.cdc_rate
+static constexpr uint32_t CDC_TX_BUFSIZE = 256;  // CFG_TUD_CDC_TX_BUFSIZE of pico_stdio_usb
+static uint32_t cdcFill = 0;  // bytes in the FIFO
+static uint64_t cdcNs = 0;    // time of the last byte taken
+
+static void _cdc_drain()
+{
+    const uint64_t n = (simNs - cdcNs) * options.cdc_rate / 1000000000;
+    if (n >= cdcFill) {
+        cdcFill = 0;
+        cdcNs = simNs;
+    } else {
+        cdcFill -= static_cast<uint32_t>(n);
+        cdcNs += n * 1000000000 / options.cdc_rate;
+    }
+}
+
+int stdio_put_string(const char* s, const int len, const bool newline, const bool)
+{
+    // blocks until the FIFO takes all the bytes (as stdio_usb does)
+    uint32_t rest = static_cast<uint32_t>(len) + (newline ? 1 : 0);
+    while (rest > 0) {
+        _cdc_drain();
+        const uint32_t n = std::min(rest, CDC_TX_BUFSIZE - cdcFill);
+        cdcFill += n;
+        rest -= n;
+        if (rest > 0 && !in_irq()) {
+            advance_to(simNs + (std::min(rest, CDC_TX_BUFSIZE) * 1000000000ULL + options.cdc_rate - 1) / options.cdc_rate);
+        } else if (rest > 0) {
+            cdcFill += rest;  // no time advances in IRQ
+            rest = 0;
+        }
+    }
+    fwrite(s, 1, len, stdout);
+    if (newline) { putchar('\n'); }
+    return len;
+}
+
+uint32_t tud_cdc_write_available()
+{
+    _cdc_drain();
+    return (cdcFill < CDC_TX_BUFSIZE) ? CDC_TX_BUFSIZE - cdcFill : 0;
+}
+
+int getchar_timeout_us(const uint32_t timeout_us)
+{
+    int c = _take_key();
+    if (c != PICO_ERROR_TIMEOUT) { return c; }
+    advance_to(simNs + static_cast<uint64_t>(timeout_us) * 1000);
+    return PICO_ERROR_TIMEOUT;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void*), void* param)
+{
+    charsAvailable = fn;
+    charsAvailableParam = param;
+}
+
+//=================================
+// interrupts
+//=================================
+void irq_set_exclusive_handler(const uint num, irq_handler_t handler)
+{
+    irqs[num].handlers.assign(1, handler);
+}
+
+void irq_add_shared_handler(const uint num, irq_handler_t handler, const uint8_t)
+{
+    irqs[num].handlers.push_back(handler);
+}
+
+bool irq_has_shared_handler(const uint num)
+{
+    return !irqs[num].handlers.empty();
+}
+
+void irq_set_priority(const uint num, const uint8_t priority)
+{
+    irqs[num].priority = priority;
+}
+
+void irq_set_enabled(const uint num, const bool enabled)
+{
+    irqs[num].enabled = enabled;
+    _dispatch();
+}
+
+void irq_set_pending(const uint num)
+{
+    raise_irq(num);
+}
+
+int user_irq_claim_unused(const bool)
+{
+    static int next = FIRST_USER_IRQ;
+    return (next < FIRST_USER_IRQ + NUM_USER_IRQS) ? next++ : -1;
+}
+
+uint32_t save_and_disable_interrupts()
+{
+    return irqMask++;
+}
+
+void restore_interrupts(const uint32_t status)
+{
+    irqMask = status;
+    _dispatch();
+}
+
+void critical_section_init(critical_section_t* crit_sec)
+{
+    crit_sec->save = 0;
+}
+
+void critical_section_enter_blocking(critical_section_t* crit_sec)
+{
+    crit_sec->save = save_and_disable_interrupts();
+}
+
+void critical_section_exit(critical_section_t* crit_sec)
+{
+    restore_interrupts(crit_sec->save);
+}
+
+//=================================
+// GPIO, ADC and clocks
+//=================================
+static std::map<uint, bool> gpioForcedLow;
+
+void gpio_init(const uint gpio)
+{
+    gpioForcedLow[gpio] = false;
+}
+
+void gpio_set_dir(const uint gpio, const bool out)
+{
+    adc_fill();
+    gpioForcedLow[gpio] = out;  // level meter drives only low
+}
+
+void gpio_put(const uint, const bool)
+{
+}
+
+bool gpio_is_forced_low(const uint gpio)
+{
+    auto it = gpioForcedLow.find(gpio);
+    return it != gpioForcedLow.end() && it->second;
+}
+
+void adc_gpio_init(const uint gpio)
+{
+    gpioForcedLow[gpio] = false;
+}
+
+uint32_t clock_get_hz(const clock_handle_t clk)
+{
+    return (clk == clk_sys) ? 150000000 : 48000000;
+}
+
+//=================================
+// PIO
+//=================================
+static pio_hw_t pio0Hw = {0};
+PIO const pio0 = &pio0Hw;
+const pio_program_t fm62429_program = {nullptr, 0, -1};
+
+uint pio_claim_unused_sm(PIO, const bool)
+{
+    return 0;
+}
+
+uint pio_add_program(PIO, const pio_program_t*)
+{
+    return 0;
+}
+
+void pio_set_irq0_source_enabled(PIO, const pio_interrupt_source_t, const bool)
+{
+}
+
+void pio_sm_put(PIO, const uint, const uint32_t data)
+{
+    pioTxFifo.push_back(data);
+    if (pioDoneNs == UINT64_MAX) {
+        pioDoneNs = simNs + FM62429_FRAME_NS;
+    }
+}
+
+//=================================
+// DMA to SPI
+//=================================
+static spi_inst_t spi1Inst = {{0, 0}};
+spi_inst_t* const spi1 = &spi1Inst;
+
+typedef struct _dma_ch_t {
+    volatile void* write_addr;
+    const volatile void* read_addr;
+    uint32_t count;
+} dma_ch_t;
+
+static constexpr int NUM_DMA_CHANNELS = 16;
+static dma_ch_t dmaCh[NUM_DMA_CHANNELS];
+static int dmaClaimed = 0;
+
+static void _dma_run(const uint channel)
+{
+    dma_ch_t& ch = dmaCh[channel];
+    if (ch.write_addr == &spi1->hw.dr) {
+        lcd_write(static_cast<const uint8_t*>(const_cast<const void*>(ch.read_addr)), ch.count);
+    }
+}
+
+int dma_claim_unused_channel(const bool)
+{
+    return (dmaClaimed < NUM_DMA_CHANNELS) ? dmaClaimed++ : -1;
+}
+
+dma_channel_config dma_channel_get_default_config(const uint)
+{
+    return dma_channel_config{DMA_SIZE_32};
+}
+
+void dma_channel_configure(const uint channel, const dma_channel_config*, volatile void* write_addr, const volatile void* read_addr, const uint transfer_count, const bool trigger)
+{
+    dmaCh[channel] = {write_addr, read_addr, transfer_count};
+    if (trigger) { _dma_run(channel); }
+}
+
+void dma_channel_set_read_addr(const uint channel, const volatile void* read_addr, const bool trigger)
+{
+    dmaCh[channel].read_addr = read_addr;
+    if (trigger) { _dma_run(channel); }
+}
+
+void dma_channel_set_trans_count(const uint channel, const uint32_t trans_count, const bool trigger)
+{
+    dmaCh[channel].count = trans_count;
+    if (trigger) { _dma_run(channel); }
+}
+
+bool dma_channel_is_busy(const uint)
+{
+    return false;  // transfers are done at trigger
+}
+
+//=================================
+// flash
+//=================================
+int flash_safe_execute(void (*func)(void*), void* param, const uint32_t)
+{
+    const uint32_t save = save_and_disable_interrupts();
+    func(param);
+    restore_interrupts(save);
+    return PICO_OK;
+}
+
+namespace FlashParamNs
+{
+
+static std::vector<ParamBase*>& _params()
+{
+    static std::vector<ParamBase*> params;
+    return params;
+}
+
+ParamBase::ParamBase(const uint32_t id, const char* name) : _id(id), _name(name)
+{
+    _params().push_back(this);
+}
+
+void FlashParam::initialize()
+{
+    if (options.flash_file.empty()) { return; }
+    std::ifstream ifs(options.flash_file);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        std::string name;
+        int64_t value;
+        if (!(iss >> name >> value)) { continue; }
+        for (ParamBase* p : _params()) {
+            if (name == p->name()) { p->set_raw(value); }
+        }
+    }
+}
+
+bool FlashParam::finalize()
+{
+    // erase and program take the flash time (XIP is off, interrupts stay disabled)
+    advance_to(simNs + static_cast<uint64_t>(options.flash_ms) * 1000000);
+    if (options.flash_file.empty()) { return true; }
+    std::ofstream ofs(options.flash_file);
+    for (const ParamBase* p : _params()) {
+        ofs << p->name() << " " << p->get_raw() << "\n";
+    }
+    return static_cast<bool>(ofs);
+}
+
+}
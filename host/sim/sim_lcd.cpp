@@ -0,0 +1,163 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator: stand-in of ST7735S LCD drawing to an in-memory framebuffer (RGB565)
+//   Characters of LCD_ShowString are kept as text and drawn as filled cells.
+
+#include "sim.h"
+
+#include <cstdio>
+#include <map>
+
+#include "lcd_extra.h"
+
+u16 BACK_COLOR = BLACK;
+
+namespace sim
+{
+
+static constexpr int LCD_LONG = 160;
+static constexpr int LCD_SHORT = 80;
+static constexpr int FONT_W = 8;
+static constexpr int FONT_H = 16;
+
+static u16 frameBuf[LCD_LONG * LCD_SHORT];
+static int width = LCD_SHORT;
+static int height = LCD_LONG;
+static int winX1, winY1, winX2, winY2;  // window of pixel writes
+static int curX, curY;
+static int pendingByte = -1;            // the upper byte of a pixel
+static uint64_t numPixels = 0;
+static std::map<std::pair<int, int>, char> textCells;
+
+static void _put_pixel(const u16 color)
+{
+    if (curX < width && curY < height) {
+        frameBuf[curY * width + curX] = color;
+    }
+    numPixels++;
+    if (++curX > winX2) {
+        curX = winX1;
+        if (++curY > winY2) { curY = winY1; }
+    }
+}
+
+void lcd_write(const uint8_t* data, const uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (pendingByte < 0) {
+            pendingByte = data[i];
+        } else {
+            _put_pixel(static_cast<u16>((pendingByte << 8) | data[i]));
+            pendingByte = -1;
+        }
+    }
+}
+
+static void _fill(const int x1, const int y1, const int x2, const int y2, const u16 color)
+{
+    for (int y = y1; y <= y2 && y < height; y++) {
+        for (int x = x1; x <= x2 && x < width; x++) {
+            frameBuf[y * width + x] = color;
+        }
+    }
+}
+
+void lcd_report()
+{
+    printf(" LCD: %llu pixels written by DMA, text:", static_cast<unsigned long long>(numPixels));
+    int row = -1;
+    int col = 0;
+    for (const auto& cell : textCells) {
+        const int y = cell.first.first;
+        const int x = cell.first.second;
+        if (y != row) {
+            printf("\r\n  y=%3d: ", y);
+            row = y;
+            col = 0;
+        }
+        for (; col < x / FONT_W; col++) { printf(" "); }
+        printf("%c", cell.second);
+        col++;
+    }
+    printf("\r\n");
+}
+
+bool lcd_write_ppm(const std::string& path)
+{
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (fp == nullptr) { return false; }
+    fprintf(fp, "P6\n%d %d\n255\n", width, height);
+    for (int i = 0; i < width * height; i++) {
+        const u16 c = frameBuf[i];
+        const uint8_t rgb[3] = {
+            static_cast<uint8_t>(((c >> 11) & 0x1f) * 255 / 31),
+            static_cast<uint8_t>(((c >> 5) & 0x3f) * 255 / 63),
+            static_cast<uint8_t>((c & 0x1f) * 255 / 31)
+        };
+        fwrite(rgb, 1, 3, fp);
+    }
+    return fclose(fp) == 0;
+}
+
+}
+
+using namespace sim;
+
+void LCD_Config(const pico_st7735_80x160_config_t*)
+{
+}
+
+void LCD_Init()
+{
+    LCD_Clear(BLACK);
+}
+
+void LCD_SetRotation(const u8 rotation)
+{
+    width = (rotation & 1) ? LCD_LONG : LCD_SHORT;
+    height = (rotation & 1) ? LCD_SHORT : LCD_LONG;
+}
+
+u16 LCD_W()
+{
+    return static_cast<u16>(width);
+}
+
+u16 LCD_H()
+{
+    return static_cast<u16>(height);
+}
+
+void LCD_Clear(const u16 color)
+{
+    _fill(0, 0, width - 1, height - 1, color);
+    textCells.clear();
+}
+
+void LCD_Address_Set(const u16 x1, const u16 y1, const u16 x2, const u16 y2)
+{
+    winX1 = x1;
+    winY1 = y1;
+    winX2 = x2;
+    winY2 = y2;
+    curX = x1;
+    curY = y1;
+    pendingByte = -1;
+}
+
+void LCD_ShowString(const u16 x, const u16 y, const u8* p, const u16 color)
+{
+    for (int k = 0; p[k] != '\0'; k++) {
+        const int cx = x + FONT_W * k;
+        const char c = static_cast<char>(p[k]);
+        _fill(cx, y, cx + FONT_W - 1, y + FONT_H - 1, BACK_COLOR);
+        if (c != ' ') {
+            _fill(cx + 1, y + 2, cx + FONT_W - 2, y + FONT_H - 3, color);
+        }
+        textCells[{y, cx}] = c;
+    }
+}
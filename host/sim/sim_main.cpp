@@ -0,0 +1,91 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator: command line and launch of the application (main() of main.cpp)
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "level_meter.h"
+#include "sim.h"
+
+int level_meter_app_main();  // main() of main.cpp
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options]\n", prog);
+    printf(" --source <spec>     sine:<freq>:<dBFS> (default: sine:997:-6), noise:<dBFS>, silence or wav:<path>\n");
+    printf(" --gain <sec>:<dB>   change the gain of the source at the time (repeatable)\n");
+    printf(" --seconds <sec>     simulated duration (default: length of WAV, otherwise 10)\n");
+    printf(" --rate <Hz>         sampling rate per channel (default: %d)\n", static_cast<int>(level_meter::DEFAULT_SAMPLE_RATE));
+    printf(" --key <sec>:<char>  type a character to serial at the time (repeatable, 'space' for ' ')\n");
+    printf(" --flash <path>      file of the settings stored to flash (loaded at boot)\n");
+    printf(" --flash-ms <ms>     time of flash erase and program (default: 50)\n");
+    printf(" --cdc-rate <B/s>    bytes per second taken by host from USB CDC transmit FIFO (default: 1000000)\n");
+    printf(" --adc-offset <LSB>  ADC code at zero input (default: 8)\n");
+    printf(" --adc-noise <LSB>   ADC noise rms (default: 0.5)\n");
+    printf(" --ppm <path>        write LCD framebuffer at the end\n");
+}
+
+int main(int argc, char* argv[])
+{
+    sim::options_t& opt = sim::options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "-h" || arg == "--help" || val == nullptr) {
+            usage(argv[0]);
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+        i++;
+        if (arg == "--source") {
+            opt.source = val;
+        } else if (arg == "--gain") {
+            double t, db;
+            if (sscanf(val, "%lf:%lf", &t, &db) != 2) { usage(argv[0]); return 1; }
+            opt.gain_steps.emplace_back(t, db);
+        } else if (arg == "--seconds") {
+            opt.seconds = atof(val);
+        } else if (arg == "--rate") {
+            opt.sample_rate = static_cast<uint32_t>(atoi(val));
+        } else if (arg == "--key") {
+            const char* colon = strchr(val, ':');
+            if (colon == nullptr) { usage(argv[0]); return 1; }
+            const char c = (strcmp(colon + 1, "space") == 0) ? ' ' : colon[1];
+            opt.keys.emplace_back(atof(val), c);
+        } else if (arg == "--flash") {
+            opt.flash_file = val;
+        } else if (arg == "--flash-ms") {
+            opt.flash_ms = static_cast<uint32_t>(atoi(val));
+        } else if (arg == "--cdc-rate") {
+            opt.cdc_rate = std::max(1, atoi(val));
+        } else if (arg == "--adc-offset") {
+            opt.adc_offset = atof(val);
+        } else if (arg == "--adc-noise") {
+            opt.adc_noise = atof(val);
+        } else if (arg == "--ppm") {
+            opt.ppm_file = val;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    double duration;
+    if (!sim::source_open(opt.source, duration)) {
+        printf("ERROR: failed to open source %s\n", opt.source.c_str());
+        return 1;
+    }
+    sim::set_duration((opt.seconds > 0.0) ? opt.seconds : duration);
+    if (opt.sample_rate > 0) {
+        level_meter::set_sample_rate(opt.sample_rate);
+    }
+
+    return level_meter_app_main();  // never returns (sim::finish() at the end of the duration)
+}
@@ -0,0 +1,131 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// host simulator: signal sources (amplitude 1.0 is 0 dBFS)
+//   sine:<freq>:<dBFS>  sine of both channels
+//   noise:<dBFS>        white gaussian noise (rms) of both channels
+//   silence
+//   wav:<path>          16 bit PCM WAV (mono or stereo), interpolated at the sampling time
+
+#include "sim.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace sim
+{
+
+enum class source_t {
+    SINE,
+    NOISE,
+    SILENCE,
+    WAV
+};
+
+static source_t source = source_t::SILENCE;
+static double sineFreq;
+static double amplitude;
+static std::vector<int16_t> wavData;
+static int wavCh;
+static uint32_t wavRate;
+static std::mt19937 rng(1);
+
+static bool _load_wav(const std::string& path)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) { return false; }
+    char riff[12];
+    bool ok = fread(riff, 1, 12, fp) == 12 && memcmp(riff, "RIFF", 4) == 0 && memcmp(&riff[8], "WAVE", 4) == 0;
+    int bits = 0;
+    while (ok) {
+        char id[4];
+        uint32_t size;
+        if (fread(id, 1, 4, fp) != 4 || fread(&size, 4, 1, fp) != 1) { ok = false; break; }
+        if (memcmp(id, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (size < 16 || fread(fmt, 1, 16, fp) != 16) { ok = false; break; }
+            wavCh = fmt[2] | (fmt[3] << 8);
+            wavRate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | (static_cast<uint32_t>(fmt[7]) << 24);
+            bits = fmt[14] | (fmt[15] << 8);
+            fseek(fp, size - 16 + (size & 1), SEEK_CUR);
+        } else if (memcmp(id, "data", 4) == 0) {
+            if (bits != 16 || wavCh < 1 || wavCh > 2) { ok = false; break; }
+            wavData.resize(size / 2);
+            ok = fread(wavData.data(), 2, wavData.size(), fp) == wavData.size();
+            break;
+        } else {
+            fseek(fp, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(fp);
+    return ok && !wavData.empty();
+}
+
+bool source_open(const std::string& spec, double& duration)
+{
+    duration = 10.0;
+    if (spec.rfind("sine:", 0) == 0) {
+        double db;
+        if (sscanf(spec.c_str(), "sine:%lf:%lf", &sineFreq, &db) != 2) { return false; }
+        source = source_t::SINE;
+        amplitude = std::pow(10.0, db / 20.0);
+    } else if (spec.rfind("noise:", 0) == 0) {
+        double db;
+        if (sscanf(spec.c_str(), "noise:%lf", &db) != 1) { return false; }
+        source = source_t::NOISE;
+        amplitude = std::pow(10.0, db / 20.0);
+    } else if (spec == "silence") {
+        source = source_t::SILENCE;
+    } else if (spec.rfind("wav:", 0) == 0) {
+        if (!_load_wav(spec.substr(4))) { return false; }
+        source = source_t::WAV;
+        duration = static_cast<double>(wavData.size() / wavCh) / wavRate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static double _gain(const double t)
+{
+    double db = 0.0;
+    for (const auto& step : options.gain_steps) {
+        if (t >= step.first) { db = step.second; }
+    }
+    return std::pow(10.0, db / 20.0);
+}
+
+float source_sample(const int ch, const double t)
+{
+    double x = 0.0;
+    switch (source) {
+    case source_t::SINE:
+        x = amplitude * std::sin(2.0 * M_PI * sineFreq * t);
+        break;
+    case source_t::NOISE:
+        x = amplitude * std::normal_distribution<double>(0.0, 1.0)(rng);
+        break;
+    case source_t::WAV:
+    {
+        const size_t numFrames = wavData.size() / wavCh;
+        const double pos = t * wavRate;
+        const size_t i = static_cast<size_t>(pos);
+        if (i + 1 >= numFrames) { break; }
+        const int c = (ch < wavCh) ? ch : 0;
+        const double a = wavData[i * wavCh + c];
+        const double b = wavData[(i + 1) * wavCh + c];
+        x = (a + (b - a) * (pos - i)) / 32768.0;
+        break;
+    }
+    default:
+        break;
+    }
+    return static_cast<float>(x * _gain(t));
+}
+
+}
@@ -0,0 +1,181 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// decoder and recorder of level telemetry ('o' command) from serial into CSV
+//   The level items are written to CSV (id, then code, level and peak hold of each channel),
+//   and the text between the frames is passed to stderr.
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "telemetry_format.h"
+#include "wire_frame.h"
+
+using namespace level_meter;
+
+static volatile sig_atomic_t stopReq = 0;
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options] <output.csv>\n", prog);
+    printf(" --port <path>     serial device of the meter (default: stdin), 'o' is sent to start and stop the telemetry\n");
+    printf(" --seconds <sec>   recording time (default: until EOF or Ctrl-C)\n");
+    printf(" --raw <path>      also write the received frames (decoded again by feeding them to stdin)\n");
+}
+
+static bool _open_port(const std::string& path, int& fd)
+{
+    fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0) { return false; }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) { return false; }
+    cfmakeraw(&tio);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string port;
+    std::string outPath;
+    std::string rawPath;
+    double seconds = 0.0;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--port" && val != nullptr) {
+            port = val;
+            i++;
+        } else if (arg == "--seconds" && val != nullptr) {
+            seconds = atof(val);
+            i++;
+        } else if (arg == "--raw" && val != nullptr) {
+            rawPath = val;
+            i++;
+        } else if (arg[0] != '-' && outPath.empty()) {
+            outPath = arg;
+        } else {
+            usage(argv[0]);
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+    if (outPath.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int fd = STDIN_FILENO;
+    if (!port.empty()) {
+        if (!_open_port(port, fd)) {
+            fprintf(stderr, "ERROR: failed to open %s\n", port.c_str());
+            return 1;
+        }
+        if (write(fd, "o", 1) != 1) {
+            fprintf(stderr, "ERROR: failed to start telemetry\n");
+            return 1;
+        }
+    }
+    FILE* csv = fopen(outPath.c_str(), "w");
+    if (csv == nullptr) {
+        fprintf(stderr, "ERROR: failed to open %s\n", outPath.c_str());
+        return 1;
+    }
+    FILE* raw = nullptr;
+    if (!rawPath.empty()) {
+        raw = fopen(rawPath.c_str(), "wb");
+        if (raw == nullptr) {
+            fprintf(stderr, "ERROR: failed to open %s\n", rawPath.c_str());
+            return 1;
+        }
+    }
+    signal(SIGINT, [](int) { stopReq = 1; });
+
+    wire_frame::decoder dec;
+    uint32_t numFrames = 0;
+    uint32_t numInvalid = 0;
+    uint64_t numItems = 0;
+    uint64_t numMissing = 0;   // ids skipped between items
+    uint64_t numBytes = 0;     // bytes of frames
+    bool hasItem = false;
+    uint32_t firstId = 0;
+    uint32_t lastId = 0;
+    uint32_t firstDropped = 0;
+    uint32_t lastDropped = 0;
+    int numCh = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    while (!stopReq) {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (seconds > 0.0 && elapsed >= seconds) { break; }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) { continue; }
+        uint8_t buf[4096];
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) { break; }  // EOF
+        for (ssize_t k = 0; k < n; k++) {
+            bool isText;
+            if (!dec.push(buf[k], isText)) {
+                if (isText) { fputc(buf[k], stderr); }
+                continue;
+            }
+            if (dec.type() != telemetry::FRAME_LEVEL) { continue; }  // frames of trace
+            telemetry::item_t items[telemetry::MAX_ITEMS];
+            int numItemsFrame;
+            uint32_t numDropped;
+            if (!telemetry::decode(dec.payload(), dec.len(), numCh, numDropped, items, numItemsFrame)) {
+                numInvalid++;
+                continue;
+            }
+            if (raw != nullptr) {
+                fwrite(dec.frame(), 1, dec.len() + wire_frame::OVERHEAD, raw);
+            }
+            if (!hasItem) {
+                firstId = items[0].id;
+                firstDropped = numDropped;
+                lastId = items[0].id - 1;
+                hasItem = true;
+            }
+            lastDropped = numDropped;
+            for (int m = 0; m < numItemsFrame; m++) {
+                const telemetry::item_t& item = items[m];
+                numMissing += item.id - lastId - 1;
+                lastId = item.id;
+                fprintf(csv, "%u", item.id);
+                for (int i = 0; i < numCh; i++) {
+                    fprintf(csv, ",%d,%d,%d", item.code[i], item.level[i], item.peak_hold[i]);
+                }
+                fprintf(csv, "\n");
+            }
+            numFrames++;
+            numItems += numItemsFrame;
+            numBytes += dec.len() + wire_frame::OVERHEAD;
+        }
+    }
+    if (!port.empty()) {
+        if (write(fd, "o", 1) != 1) {
+            fprintf(stderr, "ERROR: failed to stop telemetry\n");
+        }
+        close(fd);
+    }
+    fclose(csv);
+    if (raw != nullptr) { fclose(raw); }
+
+    fprintf(stderr, "\n[Telemetry record]\n");
+    fprintf(stderr, " %s: %u frames, %llu items of %d ch (id %u - %u)\n",
+        outPath.c_str(), numFrames, static_cast<unsigned long long>(numItems), numCh, firstId, lastId);
+    fprintf(stderr, " missing items: %llu (dropped by device: %u), invalid frames: %u, frame errors: %u\n",
+        static_cast<unsigned long long>(numMissing), lastDropped - firstDropped, numInvalid, dec.get_num_errors());
+    if (numItems > 0) {
+        fprintf(stderr, " %.1f bytes / item\n", static_cast<double>(numBytes) / numItems);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// recorder of trace of raw blocks ('w' command) from serial into a file
+//   The frames of trace are written to the file, and the text between them is passed to stderr.
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "trace_format.h"
+#include "wire_frame.h"
+
+using namespace level_meter;
+
+static volatile sig_atomic_t stopReq = 0;
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options] <output.trace>\n", prog);
+    printf(" --port <path>     serial device of the meter (default: stdin), 'w' is sent to start and stop the trace\n");
+    printf(" --seconds <sec>   recording time (default: until EOF or Ctrl-C)\n");
+}
+
+static bool _open_port(const std::string& path, int& fd)
+{
+    fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0) { return false; }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) { return false; }
+    cfmakeraw(&tio);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string port;
+    std::string outPath;
+    double seconds = 0.0;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--port" && val != nullptr) {
+            port = val;
+            i++;
+        } else if (arg == "--seconds" && val != nullptr) {
+            seconds = atof(val);
+            i++;
+        } else if (arg[0] != '-' && outPath.empty()) {
+            outPath = arg;
+        } else {
+            usage(argv[0]);
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+    if (outPath.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int fd = STDIN_FILENO;
+    if (!port.empty()) {
+        if (!_open_port(port, fd)) {
+            fprintf(stderr, "ERROR: failed to open %s\n", port.c_str());
+            return 1;
+        }
+        if (write(fd, "w", 1) != 1) {
+            fprintf(stderr, "ERROR: failed to start trace\n");
+            return 1;
+        }
+    }
+    FILE* fp = fopen(outPath.c_str(), "wb");
+    if (fp == nullptr) {
+        fprintf(stderr, "ERROR: failed to open %s\n", outPath.c_str());
+        return 1;
+    }
+    signal(SIGINT, [](int) { stopReq = 1; });
+
+    wire_frame::decoder dec;
+    trace::header_t header = {};
+    bool hasHeader = false;
+    uint32_t numHeaders = 0;
+    uint32_t numBlocks = 0;
+    uint32_t numGaps = 0;
+    uint32_t firstSeq = 0;
+    uint32_t lastSeq = 0;
+    static uint16_t raw[wire_frame::MAX_PAYLOAD];
+    const auto t0 = std::chrono::steady_clock::now();
+    while (!stopReq) {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (seconds > 0.0 && elapsed >= seconds) { break; }
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) { continue; }
+        uint8_t buf[4096];
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) { break; }  // EOF
+        for (ssize_t k = 0; k < n; k++) {
+            bool isText;
+            if (!dec.push(buf[k], isText)) {
+                if (isText) { fputc(buf[k], stderr); }
+                continue;
+            }
+            if (dec.type() == trace::FRAME_HEADER) {
+                hasHeader = trace::decode_header(dec.payload(), dec.len(), header);
+                if (!hasHeader) { continue; }
+                numHeaders++;
+            } else if (dec.type() == trace::FRAME_BLOCK && hasHeader) {
+                trace::block_t b;
+                int rawLen;
+                if (!trace::decode_block(dec.payload(), dec.len(), header.num_ch, b, raw, wire_frame::MAX_PAYLOAD, rawLen)) { continue; }
+                if (numBlocks++ == 0) { firstSeq = b.seq; }
+                lastSeq = b.seq;
+                if (b.flags & trace::FLAG_GAP) { numGaps++; }
+            } else {
+                continue;
+            }
+            fwrite(dec.frame(), 1, dec.len() + wire_frame::OVERHEAD, fp);
+        }
+    }
+    if (!port.empty()) {
+        if (write(fd, "w", 1) != 1) {
+            fprintf(stderr, "ERROR: failed to stop trace\n");
+        }
+        close(fd);
+    }
+    fclose(fp);
+
+    fprintf(stderr, "\n[Trace record]\n");
+    fprintf(stderr, " %s: %u headers, %u blocks (seq %u - %u), %u gaps, %u frame errors\n",
+        outPath.c_str(), numHeaders, numBlocks, firstSeq, lastSeq, numGaps, dec.get_num_errors());
+    if (hasHeader) {
+        fprintf(stderr, " %u Hz x %d ch, %d frames / block, oversample %d\n",
+            header.sample_rate, header.num_ch, header.block_frames, header.oversample);
+    }
+    return 0;
+}
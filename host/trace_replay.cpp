@@ -0,0 +1,204 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+// deterministic replay of trace of raw blocks through the block processing of level_meter
+//   The level items of the replay are compared with the ones produced by the device,
+//   and the time of block processing on host is measured.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "level_meter.h"
+#include "trace_format.h"
+#include "wire_frame.h"
+
+using namespace level_meter;
+
+static void usage(const char* prog)
+{
+    printf("Usage: %s [options] <input.trace>\n", prog);
+    printf(" --csv <path>     write the level items of replay (id, then code, level and peak hold of each channel)\n");
+    printf(" --repeat <n>     replay the trace n times to measure the time of block processing (default: 1)\n");
+}
+
+typedef struct _frame_t {
+    uint8_t type;
+    std::vector<uint8_t> payload;
+} frame_t;
+
+static bool _load(const std::string& path, std::vector<frame_t>& frames, uint32_t& num_errors)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) { return false; }
+    wire_frame::decoder dec;
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        bool isText;
+        if (dec.push(static_cast<uint8_t>(c), isText) && (dec.type() == trace::FRAME_HEADER || dec.type() == trace::FRAME_BLOCK)) {
+            frames.push_back({dec.type(), std::vector<uint8_t>(dec.payload(), dec.payload() + dec.len())});
+        }
+    }
+    fclose(fp);
+    num_errors = dec.get_num_errors();
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string inPath;
+    std::string csvPath;
+    int repeat = 1;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--csv" && val != nullptr) {
+            csvPath = val;
+            i++;
+        } else if (arg == "--repeat" && val != nullptr) {
+            repeat = std::max(1, atoi(val));
+            i++;
+        } else if (arg[0] != '-' && inPath.empty()) {
+            inPath = arg;
+        } else {
+            usage(argv[0]);
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+    if (inPath.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<frame_t> frames;
+    uint32_t numErrors;
+    if (!_load(inPath, frames, numErrors)) {
+        printf("ERROR: failed to open %s\n", inPath.c_str());
+        return 1;
+    }
+    trace::header_t header;
+    if (frames.empty() || frames[0].type != trace::FRAME_HEADER ||
+        !trace::decode_header(frames[0].payload.data(), static_cast<int>(frames[0].payload.size()), header)) {
+        printf("ERROR: no header at the top of %s\n", inPath.c_str());
+        return 1;
+    }
+
+    // block size profile of the device
+    int profile = 0;
+    while (profile < static_cast<int>(level_meter::block_profile_t::NUM_PROFILES) && level_meter::PROFILE_FRAMES[profile] != header.block_frames) {
+        profile++;
+    }
+    if (header.num_ch != NUM_ADC_CH || profile == static_cast<int>(level_meter::block_profile_t::NUM_PROFILES) ||
+        header.oversample != PICO_LEVEL_METER_OVERSAMPLE) {
+        printf("ERROR: trace of %d ch, %d frames / block and oversample %d needs the host build with the same options\n",
+            header.num_ch, header.block_frames, header.oversample);
+        return 1;
+    }
+    level_meter::set_block_profile(static_cast<level_meter::block_profile_t>(profile));
+
+    // dB level conversion of the device (the table is the same as conv_dB_level_lut built from the thresholds)
+    static uint8_t levelTable[1 << ADC_BITS];
+    static uint32_t levelThreshold[trace::MAX_LEVELS];
+    const bool hasLevels = header.num_levels > 0;
+    if (hasLevels) {
+        for (int k = 0; k < header.num_levels; k++) {
+            levelThreshold[k] = header.threshold[k];
+        }
+        for (int code = 0; code < (1 << ADC_BITS); code++) {
+            levelTable[code] = static_cast<uint8_t>(threshold_level(code << 8, levelThreshold, header.num_levels));
+        }
+        level_meter::init(levelTable, levelThreshold, header.num_levels);
+    } else {
+        level_meter::init();  // dB scale of the device is unknown, only the codes are compared
+    }
+
+    FILE* csv = nullptr;
+    if (!csvPath.empty()) {
+        csv = fopen(csvPath.c_str(), "w");
+        if (csv == nullptr) {
+            printf("ERROR: failed to open %s\n", csvPath.c_str());
+            return 1;
+        }
+    }
+
+    uint64_t numBlocks = 0;
+    uint64_t numCompared = 0;
+    uint64_t numMismatch = 0;
+    uint32_t numGaps = 0;
+    uint32_t numRejected = 0;
+    double ns = 0.0;
+    static uint16_t raw[wire_frame::MAX_PAYLOAD];
+    for (int r = 0; r < repeat; r++) {
+        bool comparable = false;
+        for (const auto& f : frames) {
+            const auto t0 = std::chrono::steady_clock::now();
+            const bool ok = level_meter::replay_trace(f.type, f.payload.data(), static_cast<int>(f.payload.size()));
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+            if (!ok) {
+                numRejected++;
+                continue;
+            }
+            if (f.type == trace::FRAME_HEADER) {
+                comparable = true;
+                continue;
+            }
+            trace::block_t b;
+            int rawLen;
+            trace::decode_block(f.payload.data(), static_cast<int>(f.payload.size()), NUM_ADC_CH, b, raw, wire_frame::MAX_PAYLOAD, rawLen);
+            level_item_t item;
+            uint32_t numDropped;
+            if (!level_meter::get_level_item(item, numDropped)) { continue; }
+            numBlocks++;
+            if (b.flags & trace::FLAG_GAP) {
+                // the state of the device has diverged by the blocks missing in the trace
+                if (comparable && r == 0) {
+                    printf(" gap before seq %u: not compared until next header\n", b.seq);
+                    numGaps++;
+                }
+                comparable = false;
+            }
+            if (comparable) {
+                bool match = item.id == static_cast<int>(b.seq);
+                for (int i = 0; i < NUM_ADC_CH; i++) {
+                    match = match && item.rawValue[i] == b.code[i];
+                    if (hasLevels) {
+                        match = match && item.level[i] == b.level[i] && item.peakHold[i] == b.peak_hold[i];
+                    }
+                }
+                numCompared++;
+                if (!match) {
+                    if (numMismatch == 0) {
+                        printf(" first mismatch at seq %u: replay code %d level %d, device code %d level %d (ch 0)\n",
+                            b.seq, item.rawValue[0], item.level[0], b.code[0], b.level[0]);
+                    }
+                    numMismatch++;
+                }
+            }
+            if (csv != nullptr && r == 0) {
+                fprintf(csv, "%d", item.id);
+                for (int i = 0; i < NUM_ADC_CH; i++) {
+                    fprintf(csv, ",%d,%d,%d", item.rawValue[i], item.level[i], item.peakHold[i]);
+                }
+                fprintf(csv, "\n");
+            }
+        }
+    }
+    if (csv != nullptr) { fclose(csv); }
+
+    printf("[Trace replay]\n");
+    printf(" %s: %u Hz x %d ch, %d frames / block, oversample %d\n",
+        inPath.c_str(), header.sample_rate, header.num_ch, header.block_frames, header.oversample);
+    printf(" blocks: %llu replayed, %llu compared, %llu mismatched%s, %u gaps, %u rejected frames, %u frame errors\n",
+        static_cast<unsigned long long>(numBlocks), static_cast<unsigned long long>(numCompared),
+        static_cast<unsigned long long>(numMismatch), hasLevels ? "" : " (codes only)", numGaps, numRejected, numErrors);
+    if (numBlocks > 0) {
+        printf(" block processing on host: %.1f ns / block\n", ns / numBlocks);
+    }
+    printf(" result: %s\n", (numRejected > 0 || numMismatch > 0) ? "NOT bit-exact" : "bit-exact");
+    return (numRejected > 0 || numMismatch > 0) ? 1 : 0;
+}
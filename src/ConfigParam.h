@@ -24,4 +24,15 @@ struct ConfigParam : FlashParamNs::FlashParam {
     FlashParamNs::Parameter<int32_t>     P_CFG_ATT_DB_CH_L   {ID_BASE + 0, "CFG_ATT_DB_CH_L",    0};
     FlashParamNs::Parameter<int32_t>     P_CFG_ATT_DB_CH_R   {ID_BASE + 1, "CFG_ATT_DB_CH_R",    0};
     FlashParamNs::Parameter<bool>        P_CFG_PEAK_HOLD_MODE{ID_BASE + 2, "CFG_PEAK_HOLD_MODE", true};
+    FlashParamNs::Parameter<int32_t>     P_CFG_METER_MODE    {ID_BASE + 3, "CFG_METER_MODE",     0};
+    FlashParamNs::Parameter<bool>        P_CFG_TRUE_PEAK     {ID_BASE + 4, "CFG_TRUE_PEAK",      false};
+    FlashParamNs::Parameter<bool>        P_CFG_LOUDNESS      {ID_BASE + 5, "CFG_LOUDNESS",       false};
+    FlashParamNs::Parameter<bool>        P_CFG_SPECTRUM      {ID_BASE + 6, "CFG_SPECTRUM",       false};
+    FlashParamNs::Parameter<bool>        P_CFG_AUTO_RANGE    {ID_BASE + 7, "CFG_AUTO_RANGE",     false};
+    FlashParamNs::Parameter<int32_t>     P_CFG_ADC_ZERO_L    {ID_BASE + 8, "CFG_ADC_ZERO_L",     -1};
+    FlashParamNs::Parameter<int32_t>     P_CFG_ADC_ZERO_R    {ID_BASE + 9, "CFG_ADC_ZERO_R",     -1};
+    FlashParamNs::Parameter<int32_t>     P_CFG_ADC_ZERO_CH3  {ID_BASE + 10, "CFG_ADC_ZERO_CH3",  -1};
+    FlashParamNs::Parameter<int32_t>     P_CFG_ADC_ZERO_CH4  {ID_BASE + 11, "CFG_ADC_ZERO_CH4",  -1};
+    FlashParamNs::Parameter<bool>        P_CFG_STEREO        {ID_BASE + 12, "CFG_STEREO",        false};
+    FlashParamNs::Parameter<int32_t>     P_CFG_BLOCK_PROFILE {ID_BASE + 13, "CFG_BLOCK_PROFILE", 0};
 };
@@ -0,0 +1,209 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "adc_capture.h"
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#include "level_meter.h"  // PICO_LEVEL_METER_DMA_IRQ
+#include "seq_extender.h"
+
+namespace level_meter
+{
+namespace adc_capture
+{
+
+#define DMA_IRQ_x __CONCAT(DMA_IRQ_, PICO_LEVEL_METER_DMA_IRQ)
+
+// block address table read by control channel in ring mode
+//   the read address of control channel tells the sequence number modulo SEQ_TABLE_LEN
+static constexpr int SEQ_TABLE_LEN = 256;
+static constexpr uint SEQ_TABLE_RING_BITS = 10;  // log2(SEQ_TABLE_LEN * sizeof(uint32_t))
+static uint16_t* block_addr[SEQ_TABLE_LEN] __attribute__((aligned(1 << SEQ_TABLE_RING_BITS)));
+static seq_extender<SEQ_TABLE_LEN> writeSeq;  // 32-bit sequence number of the block being written
+
+static uint      data_chan;
+static uint      ctrl_chan;
+static uint16_t* ring_buf = nullptr;
+static int       blockLen;
+static int       numBlocks;
+static uint32_t  chMask;
+static block_handler_t blockHandler = nullptr;
+
+static uint32_t sampleRate = SAMPLE_RATE_MAX;
+static uint32_t seq = 0;      // sequence number of the next block to handle
+static uint32_t numLost = 0;  // the number of blocks overwritten before being handled
+
+// prototype declaration
+static void __isr __time_critical_func(adc_capture_dma_irq_handler)();
+
+static inline uint32_t _table_idx()
+{
+    // table index of the block address which control channel loads next
+    return (dma_channel_hw_addr(ctrl_chan)->read_addr - reinterpret_cast<uintptr_t>(block_addr)) / sizeof(block_addr[0]);
+}
+
+static inline uint32_t _write_seq(const uint32_t idx)
+{
+    // the block being written (control channel has already loaded its address)
+    return writeSeq.get(idx - 1, time_us_32());
+}
+
+void init(const uint32_t ch_mask, uint16_t* buf, const int block_len, const int num_blocks, block_handler_t handler)
+{
+    ring_buf = buf;
+    blockLen = block_len;
+    numBlocks = num_blocks;
+    chMask = ch_mask;
+    blockHandler = handler;
+    for (int i = 0; i < SEQ_TABLE_LEN; i++) {
+        block_addr[i] = &ring_buf[(i % numBlocks) * blockLen];
+    }
+
+    adc_init();
+
+    adc_fifo_setup(
+        true,    // Write each completed conversion to the sample FIFO
+        true,    // Enable DMA data request (DREQ)
+        1,       // DREQ (and IRQ) asserted when at least 1 sample present
+        false,   // We won't see the ERR bit because of 8 bit reads; disable.
+        false    // Not shift each sample to 8 bits when pushing to FIFO
+    );
+
+    set_sample_rate(sampleRate);
+    adc_set_round_robin(chMask);
+
+    // Data channel: ADC FIFO -> block, then chain to control channel
+    data_chan = dma_claim_unused_channel(true);
+    ctrl_chan = dma_claim_unused_channel(true);
+    dma_channel_config cfg = dma_channel_get_default_config(data_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    // Reading from constant address, writing to incrementing byte addresses
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, true);
+    channel_config_set_dreq(&cfg, DREQ_ADC); // Pace transfers based on availability of ADC samples
+    channel_config_set_chain_to(&cfg, ctrl_chan);
+    dma_channel_configure(data_chan, &cfg,
+        ring_buf,       // dst (overwritten by control channel)
+        &adc_hw->fifo,  // src
+        blockLen,       // transfer count (reloaded at each trigger)
+        false           // start immediately
+    );
+
+    // Control channel: next block address -> data channel write address (and trigger)
+    cfg = dma_channel_get_default_config(ctrl_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_ring(&cfg, false, SEQ_TABLE_RING_BITS);  // wrap read address in the table
+    dma_channel_configure(ctrl_chan, &cfg,
+        &dma_hw->ch[data_chan].al2_write_addr_trig,  // dst
+        block_addr,                                 // src
+        1,                                          // transfer count
+        false                                       // start immediately
+    );
+}
+
+void irq_init()
+{
+    if (!irq_has_shared_handler(DMA_IRQ_x)) {
+        irq_add_shared_handler(DMA_IRQ_x, adc_capture_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    }
+    dma_irqn_set_channel_enabled(PICO_LEVEL_METER_DMA_IRQ, data_chan, true);
+    irq_set_enabled(DMA_IRQ_x, true);
+}
+
+void set_sample_rate(const uint32_t rate)
+{
+    sampleRate = (rate == 0) ? 1 : (rate > SAMPLE_RATE_MAX) ? SAMPLE_RATE_MAX : rate;
+    if (ring_buf == nullptr) { return; }  // applied at init()
+    // a conversion starts every (1 + clkdiv) cycles of clk_adc (96 cycles at minimum)
+    adc_set_clkdiv(static_cast<float>(clock_get_hz(clk_adc)) / sampleRate - 1.0f);
+    writeSeq.set_rate(blockLen, sampleRate);
+}
+
+uint32_t get_sample_rate()
+{
+    return sampleRate;
+}
+
+void start()
+{
+    // skip the block discarded by stop()
+    seq += (_table_idx() - seq) & (SEQ_TABLE_LEN - 1);
+    // Start DMA (control channel loads the first block address)
+    writeSeq.start(seq, time_us_32());
+    dma_channel_start(ctrl_chan);
+
+    adc_select_input(__builtin_ctz(chMask));  // start round-robin
+    adc_run(true);
+}
+
+void stop()
+{
+    // Stop any new conversions from starting, abort the block in progress
+    // and clean up the FIFO in case the ADC was still mid-conversion.
+    adc_run(false);
+    dma_channel_abort(data_chan);
+    adc_fifo_drain();
+    writeSeq.stop(_table_idx() - 1, time_us_32());
+}
+
+uint32_t get_num_lost()
+{
+    return numLost;
+}
+
+uint32_t get_num_unhandled()
+{
+    return _write_seq(_table_idx()) - seq;
+}
+
+uint32_t get_position()
+{
+    // read the block and the remaining count consistently around the re-arming by control channel
+    uint32_t idx, remain;
+    do {
+        idx = _table_idx();
+        remain = dma_channel_hw_addr(data_chan)->transfer_count & 0x0fffffff;  // exclude mode bits
+    } while (idx != _table_idx());
+    return _write_seq(idx) * blockLen + (blockLen - remain);
+}
+
+uint32_t get_write_seq()
+{
+    return _write_seq(_table_idx());
+}
+
+// irq handler for DMA
+static void __isr __time_critical_func(adc_capture_dma_irq_handler)()
+{
+    if (!dma_irqn_get_channel_status(PICO_LEVEL_METER_DMA_IRQ, data_chan)) { return; }
+    dma_irqn_acknowledge_channel(PICO_LEVEL_METER_DMA_IRQ, data_chan);
+
+    // the block being written now (control channel has already loaded its address)
+    const uint32_t wr = writeSeq.update(_table_idx() - 1, time_us_32());
+    uint32_t numReady = wr - seq;
+    // the ring holds (numBlocks - 1) completed blocks, older ones have been overwritten
+    if (numReady > static_cast<uint32_t>(numBlocks - 1)) {
+        const uint32_t n = numReady - (numBlocks - 1);
+        numLost += n;
+        seq += n;
+        numReady -= n;
+    }
+    while (numReady > 0) {
+        blockHandler(&ring_buf[(seq & (numBlocks - 1)) * blockLen], seq);
+        seq++;
+        numReady--;
+    }
+}
+
+}
+}
@@ -0,0 +1,101 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* gapless ADC round-robin capture into a ring of blocks
+*
+* A data DMA channel fills one block and chains to a control DMA channel,
+* which loads the next block address from a table and re-triggers the data channel.
+* No CPU is involved in re-arming, so the capture keeps running even if the IRQ is late.
+*/
+namespace adc_capture
+{
+    static constexpr uint32_t SAMPLE_RATE_MAX = 500000;  // aggregate sampling rate of all channels
+
+    /**
+    * block handler called from DMA IRQ for each completed block in order
+    *
+    * @param[in] block the interleaved samples in the block
+    * @param[in] seq the sequence number of the block
+    */
+    typedef void (*block_handler_t)(const uint16_t* block, const uint32_t seq);
+
+    /**
+    * initialization of ADC and DMA
+    *
+    * @param[in] ch_mask the bit mask of ADC inputs for round-robin
+    * @param[in] buf the ring buffer of num_blocks * block_len samples
+    * @param[in] block_len the number of samples in a block (all channels)
+    * @param[in] num_blocks the number of blocks in the ring (power of 2, 2 ~ 64)
+    * @param[in] handler the block handler
+    */
+    void init(const uint32_t ch_mask, uint16_t* buf, const int block_len, const int num_blocks, block_handler_t handler);
+
+    /**
+    * enable DMA IRQ on the calling core (the block handler runs on this core)
+    */
+    void irq_init();
+
+    /**
+    * set aggregate sampling rate of all channels
+    *
+    * @param[in] rate sampling rate in Hz (up to SAMPLE_RATE_MAX)
+    */
+    void set_sample_rate(const uint32_t rate);
+
+    /**
+    * get aggregate sampling rate of all channels
+    *
+    * @return sampling rate in Hz
+    */
+    uint32_t get_sample_rate();
+
+    /**
+    * start capture from the first channel of round-robin
+    */
+    void start();
+
+    /**
+    * stop capture (the block in progress is discarded)
+    */
+    void stop();
+
+    /**
+    * get the number of blocks overwritten before being handled
+    *
+    * @return the number of lost blocks
+    */
+    uint32_t get_num_lost();
+
+    /**
+    * get the number of completed blocks not handled yet (callable with IRQ disabled)
+    *
+    * @return the number of blocks (more than num_blocks - 1 means some of them have been overwritten)
+    */
+    uint32_t get_num_unhandled();
+
+    /**
+    * get the position of the sample being captured (callable from any context)
+    *
+    * @return the index of the next sample written by DMA (all channels, wraps around)
+    *         the first sample of block seq is at seq * block_len
+    */
+    uint32_t get_position();
+
+    /**
+    * get the sequence number of the block being written by DMA (callable from any context)
+    *
+    * @return the sequence number (the blocks before it are completed, block seq is overwritten from seq + num_blocks)
+    */
+    uint32_t get_write_seq();
+}
+}
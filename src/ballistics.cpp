@@ -0,0 +1,103 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "ballistics.h"
+
+#include <cmath>
+
+namespace level_meter
+{
+
+static int32_t _q30(const double v)
+{
+    return static_cast<int32_t>(v * (1 << 30) + 0.5);
+}
+
+static double _one_pole(const double tau_sec, const uint32_t sample_rate)
+{
+    return 1.0 - exp(-1.0 / (tau_sec * sample_rate));
+}
+
+static double _decay(const double db_per_sec, const uint32_t sample_rate)
+{
+    return pow(10.0, -db_per_sec / 20.0 / sample_rate);
+}
+
+ballistics::coef_t ballistics::get_coef(const meter_mode_t mode, const uint32_t sample_rate)
+{
+    coef_t coef = {mode, 0, 0};
+    switch (mode) {
+    case meter_mode_t::RMS:
+        coef.k_att = _q30(_one_pole(0.125, sample_rate));
+        break;
+    case meter_mode_t::VU:
+        // two cascaded poles reach 99% at 6.64 tau
+        coef.k_att = _q30(_one_pole(0.300 / 6.64, sample_rate));
+        break;
+    case meter_mode_t::PPM_TYPE_I:
+        // 10 ms burst reads -1 dB: tau = 4.5 ms
+        coef.k_att = _q30(_one_pole(0.0045, sample_rate));
+        coef.k_rel = _q30(_decay(20.0 / 1.5, sample_rate));
+        break;
+    case meter_mode_t::PPM_TYPE_II:
+        // 10 ms burst reads -4 dB: tau = 10 ms
+        coef.k_att = _q30(_one_pole(0.010, sample_rate));
+        coef.k_rel = _q30(_decay(24.0 / 2.8, sample_rate));
+        break;
+    case meter_mode_t::SAMPLE_PEAK:
+        coef.k_rel = _q30(_decay(20.0 / 1.7, sample_rate));
+        break;
+    default:
+        break;
+    }
+    return coef;
+}
+
+static int32_t _scale_q16(const int32_t v, const int32_t ratio)
+{
+    const int64_t y = (static_cast<int64_t>(v) * ratio) >> 16;
+    return (y > INT32_MAX) ? INT32_MAX : static_cast<int32_t>(y);
+}
+
+static int64_t _scale_q16(const int64_t v, const int32_t ratio)
+{
+    // upper and lower 16 bits are multiplied separately, saturated at 2^62
+    static constexpr int64_t MAX = INT64_C(1) << 62;
+    const int64_t hi = v >> 16;
+    if (ratio > 0 && hi > MAX / ratio) { return MAX; }
+    return hi * ratio + (((v & 0xffff) * ratio) >> 16);
+}
+
+void ballistics::scale(const int32_t ratio)
+{
+    switch (_coef.mode) {
+    case meter_mode_t::RMS:
+        _ms = _scale_q16(_scale_q16(_ms, ratio), ratio);  // mean square
+        break;
+    default:
+        _y1 = _scale_q16(_y1, ratio);
+        _y2 = _scale_q16(_y2, ratio);
+        break;
+    }
+}
+
+int32_t ballistics::get_value_q(const int frac) const
+{
+    switch (_coef.mode) {
+    case meter_mode_t::RMS:
+        return static_cast<int32_t>(sqrtf(static_cast<float>(_ms) * (1.0f / (INT64_C(1) << 34))) * (1 << frac));
+    case meter_mode_t::VU:
+        return _y2 >> (16 - frac);
+    case meter_mode_t::PPM_TYPE_I:
+    case meter_mode_t::PPM_TYPE_II:
+    case meter_mode_t::SAMPLE_PEAK:
+        return _y1 >> (16 - frac);
+    default:
+        return 0;
+    }
+}
+
+}
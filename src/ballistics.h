@@ -0,0 +1,188 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "dsp_util.h"
+
+namespace level_meter
+{
+/**
+* metering modes
+*/
+enum class meter_mode_t {
+    TRIMMED_MEAN = 0,  // trimmed mean of the block (legacy)
+    RMS,               // true RMS (exponential averaging, 125 ms)
+    VU,                // VU meter (99% in 300 ms)
+    PPM_TYPE_I,        // IEC 60268-10 Type I (DIN): 10 ms burst to -1 dB, return 20 dB in 1.5 s
+    PPM_TYPE_II,       // IEC 60268-10 Type II (BBC): 10 ms burst to -4 dB, return 24 dB in 2.8 s
+    SAMPLE_PEAK,       // digital sample peak: instant attack, return 20 dB in 1.7 s
+    NUM_MODES
+};
+
+/**
+* class for per-sample level detection with metering ballistics (single channel)
+*
+* All the per-sample operations are integer. The internal value is in Q16 of the calibrated ADC code,
+* and the mean square of RMS is in Q34 (64-bit) so that the step of the average does not
+* vanish at high sampling rate where the coefficient is small.
+*/
+class ballistics
+{
+public:
+    /**
+    * coefficients of ballistics (computed out of the processing path)
+    */
+    typedef struct _coef_t {
+        meter_mode_t mode;
+        int32_t k_att;  // attack coefficient (Q30)
+        int32_t k_rel;  // release coefficient (Q30)
+    } coef_t;
+
+    /**
+    * get the coefficients of the mode at the sampling rate
+    *
+    * @param[in] mode the metering mode
+    * @param[in] sample_rate the sampling rate in Hz
+    * @return the coefficients
+    */
+    static coef_t get_coef(const meter_mode_t mode, const uint32_t sample_rate);
+
+    /**
+    * constructor of ballistics
+    */
+    ballistics() : _coef{meter_mode_t::TRIMMED_MEAN, 0, 0}, _y1(0), _y2(0), _ms(0) {}
+
+    /**
+    * set the coefficients and reset the state
+    *
+    * @param[in] coef the coefficients
+    */
+    void set_coef(const coef_t& coef)
+    {
+        _coef = coef;
+        _y1 = 0;
+        _y2 = 0;
+        _ms = 0;
+    }
+
+    /**
+    * get the metering mode
+    *
+    * @return the metering mode
+    */
+    meter_mode_t get_mode() const { return _coef.mode; }
+
+    /**
+    * process interleaved samples of the channel
+    *
+    * @param[in] samples the pointer to the first sample of the channel (uint16_t: raw ADC code, int32_t: Q4 of ADC code)
+    * @param[in] stride the interval of the samples of the channel
+    * @param[in] len the number of samples of the channel
+    * @param[in] gain the calibration gain (Q16)
+    * @param[in] ofs the calibration offset in ADC code
+    */
+    template <typename T>
+    inline void process(const T* samples, const int stride, const int len, const int32_t gain, const int32_t ofs)
+    {
+        switch (_coef.mode) {
+        case meter_mode_t::RMS:
+            for (int j = 0; j < len; j++) {
+                const int32_t x2 = _in_sq(samples[j * stride], gain, ofs);
+                _ms += _mul_q30((static_cast<int64_t>(x2) << 30) - _ms, _coef.k_att);  // mean square in Q34
+            }
+            break;
+        case meter_mode_t::VU:
+            for (int j = 0; j < len; j++) {
+                const int32_t x = _in_q16(samples[j * stride], gain, ofs);
+                _y1 += _mul_q30(x, _coef.k_att, _y1);
+                _y2 += _mul_q30(_y1, _coef.k_att, _y2);
+            }
+            break;
+        case meter_mode_t::PPM_TYPE_I:
+        case meter_mode_t::PPM_TYPE_II:
+            for (int j = 0; j < len; j++) {
+                const int32_t x = _in_q16(samples[j * stride], gain, ofs);
+                if (x > _y1) {
+                    _y1 += _mul_q30(x, _coef.k_att, _y1);
+                } else {
+                    _y1 = _mul_q30(_y1, _coef.k_rel, 0);  // exponential decay (constant dB/s)
+                }
+            }
+            break;
+        case meter_mode_t::SAMPLE_PEAK:
+            for (int j = 0; j < len; j++) {
+                const int32_t x = _in_q16(samples[j * stride], gain, ofs);
+                _y1 = (x > _y1) ? x : _mul_q30(_y1, _coef.k_rel, 0);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+    * scale the state (at the gain switch of the input)
+    *
+    * @param[in] ratio the ratio of new gain to old gain (Q16)
+    */
+    void scale(const int32_t ratio);
+
+    /**
+    * get the detected value
+    *
+    * @return the value in calibrated ADC code
+    */
+    int32_t get_value() const { return get_value_q(0); }
+
+    /**
+    * get the detected value with fractional bits
+    *
+    * @param[in] frac the fractional bits (0 ~ 16)
+    * @return the value in calibrated ADC code (Q frac)
+    */
+    int32_t get_value_q(const int frac) const;
+
+protected:
+    coef_t _coef;
+    int32_t _y1;  // first stage (Q16)
+    int32_t _y2;  // second stage (Q16)
+    int64_t _ms;  // mean square of RMS (Q34)
+
+    // calibrated sample in Q16 and its square in Q4
+    static inline int32_t _in_q16(const uint16_t raw, const int32_t gain, const int32_t ofs)
+    {
+        return dsp::calib(raw, gain, ofs) << 16;
+    }
+    static inline int32_t _in_q16(const int32_t raw, const int32_t gain, const int32_t ofs)
+    {
+        return dsp::calib_hr(raw, gain, ofs) << (16 - dsp::HR_FRAC);
+    }
+    static inline int32_t _in_sq(const uint16_t raw, const int32_t gain, const int32_t ofs)
+    {
+        const int32_t x = dsp::calib(raw, gain, ofs);
+        return (x * x) << 4;
+    }
+    static inline int32_t _in_sq(const int32_t raw, const int32_t gain, const int32_t ofs)
+    {
+        const uint32_t x = static_cast<uint32_t>(dsp::calib_hr(raw, gain, ofs));
+        return static_cast<int32_t>((x * x) >> (dsp::HR_FRAC * 2 - 4));
+    }
+
+    static inline int32_t _mul_q30(const int32_t x, const int32_t k, const int32_t y)
+    {
+        // (x - y) * k in Q30
+        return static_cast<int32_t>((static_cast<int64_t>(x - y) * k) >> 30);
+    }
+    static inline int64_t _mul_q30(const int64_t x, const int32_t k)
+    {
+        // x * k in Q30 (x up to 2^62: upper and lower 30 bits are multiplied separately)
+        return (x >> 30) * k + (((x & ((1 << 30) - 1)) * k) >> 30);
+    }
+};
+}
@@ -0,0 +1,98 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "dsp_util.h"
+
+namespace level_meter
+{
+/**
+* class for oversampling front end: 3-stage CIC decimator with droop compensation FIR (single channel)
+*
+* The integrators run at the input rate and the combs at the output rate in modular 32-bit
+* arithmetic (bit growth of 12 + 3 * log2(R) bits). The compensation is a 3-tap FIR
+* (-1, 10, -1) / 8 at the output rate, which flattens the sinc^3 droop to the second order.
+* The output is in Q4 of ADC code (one output sample of delay by the FIR).
+*
+* @tparam R the decimation ratio (power of 2, 2 ~ 64)
+*/
+template <int R>
+class cic_decimator
+{
+public:
+    static_assert(R >= 2 && R <= 64 && (R & (R - 1)) == 0, "R must be power of 2 up to 64");
+    static constexpr int ORDER = 3;
+    static constexpr int FRAC = dsp::HR_FRAC;  // fractional bits of output
+    static constexpr int LOG2_R = __builtin_ctz(R);
+    static constexpr int SPAN = ORDER + 2;  // output samples affected by a step of input (CIC and FIR)
+
+    /**
+    * constructor of cic_decimator
+    */
+    cic_decimator() { reset(); }
+
+    /**
+    * reset integrators, combs and FIR history
+    */
+    void reset()
+    {
+        _i1 = _i2 = _i3 = 0;
+        _c1 = _c2 = _c3 = 0;
+        _x1 = _x2 = 0;
+    }
+
+    /**
+    * decimate interleaved samples of the channel
+    *
+    * @param[in] samples the pointer to the first input sample of the channel
+    * @param[in] stride the interval of the input samples of the channel
+    * @param[in] len the number of output samples (len * R input samples are consumed)
+    * @param[out] out the pointer to the first output sample of the channel (Q4 of ADC code)
+    * @param[in] out_stride the interval of the output samples of the channel
+    */
+    inline void process(const uint16_t* samples, const int stride, const int len, int32_t* out, const int out_stride)
+    {
+        for (int j = 0; j < len; j++) {
+            const uint16_t* s = &samples[j * R * stride];
+            for (int k = 0; k < R; k++) {
+                _i1 += s[k * stride];
+                _i2 += _i1;
+                _i3 += _i2;
+            }
+            const uint32_t d1 = _i3 - _c1;
+            _c1 = _i3;
+            const uint32_t d2 = d1 - _c2;
+            _c2 = d1;
+            const uint32_t d3 = d2 - _c3;
+            _c3 = d2;
+            // gain R^3 removed, 3 extra bits are kept for FIR
+            const int32_t x0 = _scale(d3);
+            const int32_t y = (10 * _x1 - x0 - _x2 + (1 << 5)) >> 6;
+            _x2 = _x1;
+            _x1 = x0;
+            out[j * out_stride] = (y < 0) ? 0 : y;
+        }
+    }
+
+protected:
+    static constexpr int SHIFT = ORDER * LOG2_R - (FRAC + 3);
+    uint32_t _i1, _i2, _i3;  // integrators
+    uint32_t _c1, _c2, _c3;  // comb delays
+    int32_t _x1, _x2;        // FIR history (Q7)
+
+    static inline int32_t _scale(const uint32_t v)
+    {
+        if constexpr (SHIFT > 0) {
+            return static_cast<int32_t>((v + (1u << (SHIFT - 1))) >> SHIFT);
+        } else {
+            return static_cast<int32_t>(v << -SHIFT);
+        }
+    }
+};
+}
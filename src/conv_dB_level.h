@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
@@ -48,4 +49,106 @@ protected:
     std::vector<float> _linear_scale;
     float _db_to_linear(float db);
 };
-}
\ No newline at end of file
+
+/**
+* compile-time lookup table for converting the calibrated ADC codes to the levels in dB scale
+*
+* @tparam NUM_LEVELS the number of steps in dB scale
+* @tparam ADC_BITS the resolution of ADC
+* @tparam RANGE_NUM the numerator of the ratio of full scale input to ADC full scale
+* @tparam RANGE_DEN the denominator of the ratio of full scale input to ADC full scale
+*/
+template <int NUM_LEVELS, int ADC_BITS, int RANGE_NUM, int RANGE_DEN>
+class conv_dB_level_lut
+{
+public:
+    static_assert(NUM_LEVELS > 0 && NUM_LEVELS < 256, "NUM_LEVELS must be in range of uint8_t");
+    static constexpr int NUM_CODES = 1 << ADC_BITS;
+    static constexpr int CODE_MAX = NUM_CODES - 1;
+    static constexpr int TH_FRAC = 8;  // fractional bits of thresholds
+
+    /**
+    * constructor of conv_dB_level_lut (evaluated at compile time)
+    *
+    * @param[in] db_scale the series of dB scale in array, which needs to be ascending order
+    */
+    constexpr conv_dB_level_lut(const float (&db_scale)[NUM_LEVELS]) : _table(), _th()
+    {
+        // threshold code for each step in dB scale (normalized to max)
+        double th[NUM_LEVELS] = {};
+        for (int k = 0; k < NUM_LEVELS; k++) {
+            th[k] = _db_to_linear(db_scale[k] - db_scale[NUM_LEVELS - 1]) * CODE_MAX * RANGE_NUM / RANGE_DEN;
+            const double q = th[k] * (1 << TH_FRAC);
+            _th[k] = static_cast<uint32_t>(q) + ((static_cast<uint32_t>(q) < q) ? 1 : 0);  // ceil
+        }
+        // same result as conv_dB_level::get_level (upper_bound) for code / CODE_MAX / RANGE_RATIO
+        int level = 0;
+        for (int code = 0; code < NUM_CODES; code++) {
+            while (level < NUM_LEVELS && th[level] <= code) { level++; }
+            _table[code] = static_cast<uint8_t>(level);
+        }
+    }
+
+    /**
+    * get the level from the calibrated ADC code
+    *
+    * @param[in] code the calibrated ADC code (clipped to 0 ~ CODE_MAX)
+    * @return the level corresponding to the series of dB scale
+    */
+    inline unsigned int get_level(const int32_t code) const
+    {
+        return _table[(code < 0) ? 0 : (code > CODE_MAX) ? CODE_MAX : code];
+    }
+
+    /**
+    * get the flat table indexed by the calibrated ADC code
+    *
+    * @return the pointer to the table with NUM_CODES entries
+    */
+    constexpr const uint8_t* table() const { return _table; }
+
+    /**
+    * get the threshold of each step for codes with fractional bits
+    *
+    * @return the pointer to NUM_LEVELS thresholds in Q8 of calibrated ADC code (the level is the number of thresholds <= code)
+    */
+    constexpr const uint32_t* threshold() const { return _th; }
+
+protected:
+    uint8_t _table[NUM_CODES];
+    uint32_t _th[NUM_LEVELS];
+
+    static constexpr double _exp(double x)
+    {
+        // Taylor series after scaling down by 2^10, then square it back
+        double y = x / 1024;
+        double sum = 1.0;
+        double term = 1.0;
+        for (int n = 1; n < 12; n++) {
+            term *= y / n;
+            sum += term;
+        }
+        for (int n = 0; n < 10; n++) {
+            sum *= sum;
+        }
+        return sum;
+    }
+    static constexpr double _db_to_linear(double db)
+    {
+        return _exp(db * 0.11512925464970229);  // ln(10) / 20
+    }
+};
+
+/**
+* get the level from the code with fractional bits by the thresholds of conv_dB_level_lut
+*
+* @param[in] code the calibrated ADC code in Q8
+* @param[in] th the thresholds in Q8 (ascending order)
+* @param[in] num the number of thresholds
+* @return the level (the number of thresholds <= code)
+*/
+static inline unsigned int threshold_level(const int32_t code, const uint32_t th[], const int num)
+{
+    return std::upper_bound(th, th + num, static_cast<uint32_t>((code < 0) ? 0 : code)) - th;
+}
+}
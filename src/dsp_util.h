@@ -0,0 +1,241 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#endif
+
+namespace level_meter
+{
+namespace dsp
+{
+    static constexpr int32_t CODE_MAX = 4095;  // 12bit ADC
+
+    /**
+    * apply calibration to a raw ADC sample
+    *
+    * @param[in] raw the raw ADC sample
+    * @param[in] gain the calibration gain (Q16)
+    * @param[in] ofs the calibration offset in ADC code
+    * @return the calibrated code (0 ~ CODE_MAX)
+    */
+    static inline int32_t calib(const uint16_t raw, const int32_t gain, const int32_t ofs)
+    {
+        const int32_t x = ((static_cast<int32_t>(raw) * gain) >> 16) + ofs;
+        return (x < 0) ? 0 : (x > CODE_MAX) ? CODE_MAX : x;
+    }
+
+    static constexpr int HR_FRAC = 4;  // fractional bits of high resolution samples (oversampling front end)
+
+    /**
+    * apply calibration to a high resolution sample
+    *
+    * @param[in] raw the raw sample in Q4 of ADC code
+    * @param[in] gain the calibration gain (Q16)
+    * @param[in] ofs the calibration offset in ADC code
+    * @return the calibrated code in Q4 (0 ~ CODE_MAX in Q4)
+    */
+    static inline int32_t calib_hr(const int32_t raw, const int32_t gain, const int32_t ofs)
+    {
+        const int32_t x = static_cast<int32_t>((static_cast<int64_t>(raw) * gain) >> 16) + (ofs << HR_FRAC);
+        return (x < 0) ? 0 : (x > (CODE_MAX << HR_FRAC)) ? (CODE_MAX << HR_FRAC) : x;
+    }
+
+    /**
+    * load two packed int16 values (unaligned access is allowed)
+    *
+    * @param[in] p the pointer to the first value (lower half)
+    * @return the packed values
+    */
+    static inline uint32_t load_pair(const int16_t* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /**
+    * dual 16-bit multiply with accumulate (SMLAD of M33 DSP extension)
+    *
+    * @param[in] x the packed int16 pair
+    * @param[in] y the packed int16 pair
+    * @param[in] acc the accumulator
+    * @return acc + x.lo * y.lo + x.hi * y.hi
+    */
+    static inline int32_t smlad(const uint32_t x, const uint32_t y, const int32_t acc)
+    {
+#if defined(__ARM_FEATURE_SIMD32)
+        return __smlad(x, y, acc);
+#else
+        return acc + static_cast<int16_t>(x) * static_cast<int16_t>(y)
+                   + static_cast<int16_t>(x >> 16) * static_cast<int16_t>(y >> 16);
+#endif
+    }
+
+    /**
+    * pack two int16 values (complex number of re and im)
+    *
+    * @param[in] lo the lower half (re)
+    * @param[in] hi the upper half (im)
+    * @return the packed values
+    */
+    static inline uint32_t pack(const int32_t lo, const int32_t hi)
+    {
+        return static_cast<uint16_t>(lo) | (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16);
+    }
+
+    /**
+    * lower half of the packed values as int16
+    */
+    static inline int32_t lo(const uint32_t x) { return static_cast<int16_t>(x); }
+
+    /**
+    * upper half of the packed values as int16
+    */
+    static inline int32_t hi(const uint32_t x) { return static_cast<int16_t>(x >> 16); }
+
+    /**
+    * dual 16-bit multiply with addition (SMUAD)
+    *
+    * @return x.lo * y.lo + x.hi * y.hi
+    */
+    static inline int32_t smuad(const uint32_t x, const uint32_t y)
+    {
+#if defined(__ARM_FEATURE_SIMD32)
+        return __smuad(x, y);
+#else
+        return lo(x) * lo(y) + hi(x) * hi(y);
+#endif
+    }
+
+    /**
+    * dual 16-bit multiply with subtraction (SMUSD)
+    *
+    * @return x.lo * y.lo - x.hi * y.hi (real part of complex multiplication)
+    */
+    static inline int32_t smusd(const uint32_t x, const uint32_t y)
+    {
+#if defined(__ARM_FEATURE_SIMD32)
+        return __smusd(x, y);
+#else
+        return lo(x) * lo(y) - hi(x) * hi(y);
+#endif
+    }
+
+    /**
+    * dual 16-bit multiply with exchange and addition (SMUADX)
+    *
+    * @return x.lo * y.hi + x.hi * y.lo (imaginary part of complex multiplication)
+    */
+    static inline int32_t smuadx(const uint32_t x, const uint32_t y)
+    {
+#if defined(__ARM_FEATURE_SIMD32)
+        return __smuadx(x, y);
+#else
+        return lo(x) * hi(y) + hi(x) * lo(y);
+#endif
+    }
+
+    /**
+    * dual 16-bit multiply with subtraction and accumulate (SMLSD)
+    *
+    * @return acc + x.lo * y.lo - x.hi * y.hi
+    */
+    static inline int32_t smlsd(const uint32_t x, const uint32_t y, const int32_t acc)
+    {
+#if defined(__ARM_FEATURE_SIMD32)
+        return __smlsd(x, y, acc);
+#else
+        return acc + lo(x) * lo(y) - hi(x) * hi(y);
+#endif
+    }
+
+    /**
+    * dual 16-bit multiply with exchange and accumulate (SMLADX)
+    *
+    * @return acc + x.lo * y.hi + x.hi * y.lo
+    */
+    static inline int32_t smladx(const uint32_t x, const uint32_t y, const int32_t acc)
+    {
+#if defined(__ARM_FEATURE_SIMD32)
+        return __smladx(x, y, acc);
+#else
+        return acc + lo(x) * hi(y) + hi(x) * lo(y);
+#endif
+    }
+
+    /**
+    * biquad filter of Direct Form I in Q28 coefficients with error feedback
+    * (the truncation error is carried to the next sample for low frequency poles)
+    */
+    class biquad
+    {
+    public:
+        static constexpr int Q = 28;  // coefficients in -8.0 ~ 8.0
+
+        biquad() : _b0(1 << Q), _b1(0), _b2(0), _a1(0), _a2(0) { reset(); }
+
+        /**
+        * set coefficients (a0 is normalized to 1) and reset state
+        *
+        * @param[in] b numerator coefficients b0, b1, b2
+        * @param[in] a denominator coefficients a1, a2
+        */
+        void set_coef(const double b[3], const double a[2])
+        {
+            _b0 = _q(b[0]);
+            _b1 = _q(b[1]);
+            _b2 = _q(b[2]);
+            _a1 = _q(a[0]);
+            _a2 = _q(a[1]);
+            reset();
+        }
+
+        /**
+        * reset state
+        */
+        void reset()
+        {
+            _x1 = _x2 = _y1 = _y2 = 0;
+            _err = 0;
+        }
+
+        /**
+        * process a sample
+        *
+        * @param[in] x the input sample
+        * @return the output sample
+        */
+        inline int32_t process(const int32_t x)
+        {
+            const int64_t acc = static_cast<int64_t>(_b0) * x + static_cast<int64_t>(_b1) * _x1 + static_cast<int64_t>(_b2) * _x2
+                              - static_cast<int64_t>(_a1) * _y1 - static_cast<int64_t>(_a2) * _y2 + _err;
+            const int32_t y = static_cast<int32_t>(acc >> Q);
+            _err = static_cast<int32_t>(acc & ((1 << Q) - 1));
+            _x2 = _x1;
+            _x1 = x;
+            _y2 = _y1;
+            _y1 = y;
+            return y;
+        }
+
+    protected:
+        int32_t _b0, _b1, _b2, _a1, _a2;
+        int32_t _x1, _x2, _y1, _y2;
+        int32_t _err;
+
+        static int32_t _q(const double v)
+        {
+            return static_cast<int32_t>(v * (1 << Q) + ((v < 0) ? -0.5 : 0.5));
+        }
+    };
+}
+}
@@ -0,0 +1,93 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "event_loop.h"
+
+#include <algorithm>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+event_loop::event_loop() :
+    _num_events(0), _pending(0), _idle_us(0), _ref_us(0), _num_wakeups(0)
+{
+}
+
+int event_loop::add(handler_t handler)
+{
+    return _add(handler, 0);
+}
+
+int event_loop::add_periodic(handler_t handler, const uint32_t interval_us)
+{
+    if (interval_us == 0) { return -1; }
+    return _add(handler, interval_us);
+}
+
+int event_loop::_add(handler_t handler, const uint32_t interval_us)
+{
+    if (_num_events >= MAX_EVENTS || handler == nullptr) { return -1; }
+    event_t& ev = _events[_num_events];
+    ev.handler = handler;
+    ev.interval_us = interval_us;
+    ev.next_us = time_us_64() + interval_us;
+    return _num_events++;
+}
+
+void event_loop::post(const int id)
+{
+    if (id < 0 || id >= MAX_EVENTS) { return; }
+    _pending.fetch_or(1u << id, std::memory_order_release);
+    __sev();  // wakes WFE of dispatch() on either core
+}
+
+void event_loop::dispatch(const uint32_t max_wait_us)
+{
+    uint64_t now = time_us_64();
+    uint64_t wake = (max_wait_us == NO_TIMEOUT) ? UINT64_MAX : now + max_wait_us;
+    for (int i = 0; i < _num_events; i++) {
+        if (_events[i].interval_us > 0) { wake = std::min(wake, _events[i].next_us); }
+    }
+    // an event posted before WFE leaves the event register set, then WFE returns at once
+    while (_pending.load(std::memory_order_acquire) == 0 && now < wake) {
+        if (wake == UINT64_MAX) {
+            __wfe();
+        } else {
+            best_effort_wfe_or_timeout(from_us_since_boot(wake));
+        }
+        const uint64_t t = time_us_64();
+        _idle_us += t - now;
+        now = t;
+    }
+    _num_wakeups++;
+
+    uint32_t pending = _pending.exchange(0, std::memory_order_acquire);
+    for (int i = 0; i < _num_events; i++) {
+        event_t& ev = _events[i];
+        if (ev.interval_us > 0 && now >= ev.next_us) {
+            ev.next_us += ev.interval_us;
+            if (ev.next_us <= now) { ev.next_us = now + ev.interval_us; }  // skip the missed ticks
+            pending |= 1u << i;
+        }
+        if (pending & (1u << i)) {
+            ev.handler();
+        }
+    }
+}
+
+float event_loop::get_idle_ratio()
+{
+    const uint64_t now = time_us_64();
+    const float ratio = (now > _ref_us) ? static_cast<float>(_idle_us) / (now - _ref_us) : 0.0f;
+    _idle_us = 0;
+    _ref_us = now;
+    return std::min(ratio, 1.0f);
+}
+
+uint32_t event_loop::get_num_wakeups() const
+{
+    return _num_wakeups;
+}
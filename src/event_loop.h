@@ -0,0 +1,88 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+* event-driven scheduler of the main loop
+*
+* Events are posted from any context (IRQ or the other core) by setting a pending bit and SEV,
+* timer events are due at a fixed interval. dispatch() sleeps by WFE until an event is posted,
+* a timer is due or an interrupt is taken, then runs the handlers of the events in the order
+* of registration. A timer behind by more than one interval skips the missed ticks.
+*/
+class event_loop
+{
+public:
+    static constexpr int MAX_EVENTS = 8;
+    static constexpr uint32_t NO_TIMEOUT = UINT32_MAX;
+    typedef void (*handler_t)();
+
+    event_loop();
+
+    /**
+    * @brief register an event run by post()
+    *
+    * @param handler the handler run in dispatch()
+    * @return event id (-1 if no room)
+    */
+    int add(handler_t handler);
+
+    /**
+    * @brief register a timer event at a fixed interval
+    *
+    * @param handler the handler run in dispatch()
+    * @param interval_us the interval in us
+    * @return event id (-1 if no room)
+    */
+    int add_periodic(handler_t handler, const uint32_t interval_us);
+
+    /**
+    * @brief post an event (callable from IRQ and the other core)
+    *
+    * @param id event id
+    */
+    void post(const int id);
+
+    /**
+    * @brief sleep until events, then run the handlers of them
+    *
+    * @param max_wait_us the maximum sleep in us (NO_TIMEOUT: until an event)
+    */
+    void dispatch(const uint32_t max_wait_us = NO_TIMEOUT);
+
+    /**
+    * @brief get the ratio of time slept in dispatch() since the last call
+    *
+    * @return idle ratio (0.0 ~ 1.0)
+    */
+    float get_idle_ratio();
+
+    /**
+    * @brief get the number of wake-ups of dispatch()
+    *
+    * @return the number of wake-ups
+    */
+    uint32_t get_num_wakeups() const;
+
+protected:
+    typedef struct _event_t {
+        handler_t handler;
+        uint32_t interval_us;  // 0 if posted
+        uint64_t next_us;      // due time of timer
+    } event_t;
+    event_t _events[MAX_EVENTS];
+    int _num_events;
+    std::atomic<uint32_t> _pending;  // bit for each event id
+    uint64_t _idle_us;
+    uint64_t _ref_us;  // start of get_idle_ratio() period
+    uint32_t _num_wakeups;
+
+    int _add(handler_t handler, const uint32_t interval_us);
+};
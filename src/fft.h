@@ -0,0 +1,111 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "dsp_util.h"
+
+namespace level_meter
+{
+/**
+* fixed-point radix-4 FFT (decimation in frequency, in-place)
+*
+* Complex numbers are packed Q15 (re: lower half, im: upper half) so that twiddle
+* multiplication is done by dual 16-bit multiplies (SMUSD / SMUADX).
+* Each stage is scaled by 1/4, so the output is scaled by 1/N and never overflows
+* as long as the magnitude of input is within 32767.
+*
+* @tparam N the number of points (power of 4)
+*/
+template <int N>
+class fft_radix4
+{
+public:
+    static_assert(N >= 4 && (N & (N - 1)) == 0 && (__builtin_ctz(N) % 2) == 0, "N must be power of 4");
+    static constexpr int LOG4_N = __builtin_ctz(N) / 2;
+
+    /**
+    * constructor of fft_radix4 (twiddle factors and digit reversal table)
+    */
+    fft_radix4()
+    {
+        constexpr double PI = 3.14159265358979323846;
+        for (int k = 0; k < N * 3 / 4; k++) {
+            const double ph = -2.0 * PI * k / N;
+            _tw[k] = dsp::pack(static_cast<int32_t>(lround(cos(ph) * 32767.0)), static_cast<int32_t>(lround(sin(ph) * 32767.0)));
+        }
+        for (int i = 0; i < N; i++) {
+            int r = 0;
+            int v = i;
+            for (int d = 0; d < LOG4_N; d++) {
+                r = (r << 2) | (v & 3);
+                v >>= 2;
+            }
+            _rev[i] = static_cast<uint16_t>(r);
+        }
+    }
+
+    /**
+    * forward FFT scaled by 1/N
+    *
+    * @param[in,out] x the packed complex numbers in natural order (input and output)
+    */
+    void forward(uint32_t x[N]) const
+    {
+        for (int n = N; n > 1; n >>= 2) {
+            const int q = n >> 2;
+            const int step = N / n;
+            for (int j = 0; j < q; j++) {
+                const uint32_t w1 = _tw[j * step];
+                const uint32_t w2 = _tw[j * step * 2];
+                const uint32_t w3 = _tw[j * step * 3];
+                for (int k = j; k < N; k += n) {
+                    _butterfly(&x[k], q, w1, w2, w3);
+                }
+            }
+        }
+        // base-4 digit reversal
+        for (int i = 0; i < N; i++) {
+            const int r = _rev[i] & (N - 1);  // _rev[i] < N (the mask makes it obvious to the compiler)
+            if (i < r) {
+                const uint32_t t = x[i];
+                x[i] = x[r];
+                x[r] = t;
+            }
+        }
+    }
+
+protected:
+    uint32_t _tw[N * 3 / 4];  // e^(-2 pi i k / N)
+    uint16_t _rev[N];
+
+    static inline uint32_t _twiddle(const int32_t re, const int32_t im, const uint32_t w)
+    {
+        const uint32_t y = dsp::pack(re, im);
+        return dsp::pack((dsp::smusd(y, w) + 0x4000) >> 15, (dsp::smuadx(y, w) + 0x4000) >> 15);
+    }
+
+    static inline void _butterfly(uint32_t* x, const int q, const uint32_t w1, const uint32_t w2, const uint32_t w3)
+    {
+        // sums in 1/2 scale, the rest of 1/2 is applied with rounding
+        const int32_t ar = dsp::lo(x[0]),     ai = dsp::hi(x[0]);
+        const int32_t br = dsp::lo(x[q]),     bi = dsp::hi(x[q]);
+        const int32_t cr = dsp::lo(x[q * 2]), ci = dsp::hi(x[q * 2]);
+        const int32_t dr = dsp::lo(x[q * 3]), di = dsp::hi(x[q * 3]);
+        const int32_t t0r = (ar + cr) >> 1, t0i = (ai + ci) >> 1;
+        const int32_t t1r = (ar - cr) >> 1, t1i = (ai - ci) >> 1;
+        const int32_t t2r = (br + dr) >> 1, t2i = (bi + di) >> 1;
+        const int32_t t3r = (br - dr) >> 1, t3i = (bi - di) >> 1;
+        x[0]     = dsp::pack((t0r + t2r + 1) >> 1, (t0i + t2i + 1) >> 1);
+        x[q]     = _twiddle((t1r + t3i + 1) >> 1, (t1i - t3r + 1) >> 1, w1);  // t1 - j * t3
+        x[q * 2] = _twiddle((t0r - t2r + 1) >> 1, (t0i - t2i + 1) >> 1, w2);
+        x[q * 3] = _twiddle((t1r - t3i + 1) >> 1, (t1i + t3r + 1) >> 1, w3);  // t1 + j * t3
+    }
+};
+}
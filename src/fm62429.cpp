@@ -6,27 +6,64 @@
 
 #include "fm62429.h"
 
+#include "hardware/clocks.h"
+#include "hardware/irq.h"
+#include "fm62429.pio.h"
+#include "perf_stats.h"
+
+fm62429* fm62429::_instance = nullptr;
+
+fm62429::fm62429(const uint pin_clock, const uint pin_data) :
+    _pin_clock(pin_clock), _pin_data(pin_data), _pio(pio0), _sm(0), _in_flight(false), _num_coalesced(0), _done_callback(nullptr)
+{
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        _pending[i] = NO_CODE;
+    }
+}
+
 void fm62429::init()
 {
-    gpio_init(_pin_clock);
-    gpio_set_dir(_pin_clock, GPIO_OUT);
-    gpio_put(_pin_clock, true);
-    gpio_init(_pin_data);
-    gpio_set_dir(_pin_data, GPIO_OUT);
-    gpio_put(_pin_data, true);
+    _instance = this;
+    critical_section_init(&_crit_sec);
+    _sm = pio_claim_unused_sm(_pio, true);
+    const uint offset = pio_add_program(_pio, &fm62429_program);
+    // 1 instruction for each quarter cycle
+    const float clkdiv = static_cast<float>(clock_get_hz(clk_sys)) * QUARTER_CYC_US / 1000000;
+    fm62429_program_init(_pio, _sm, offset, _pin_data, _pin_clock, clkdiv);
+    // IRQ at the end of each frame (irq flag relative to state machine)
+    pio_interrupt_clear(_pio, _sm);
+    pio_set_irq0_source_enabled(_pio, static_cast<pio_interrupt_source_t>(pis_interrupt0 + _sm), true);
+    irq_add_shared_handler(pio_get_irq_num(_pio, 0), _irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(pio_get_irq_num(_pio, 0), true);
 }
 
 void fm62429::set_att(const uint8_t ch, const int8_t db)
 {
     if (ch >= NUM_CH) { return; }
     const uint16_t code = (0b11 << 9) + (get_att_code(db) << 2) + 0b10 + ch;
-    send_code(code);
+    send_code(ch, code);
 }
 
 void fm62429::set_att_both(const int8_t db)
 {
     const uint16_t code = (0b11 << 9) + (get_att_code(db) << 2) + 0b00;
-    send_code(code);
+    send_code(SLOT_BOTH, code);
+}
+
+bool fm62429::busy() const
+{
+    if (_in_flight) { return true; }
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        if (_pending[i] != NO_CODE) { return true; }
+    }
+    return false;
+}
+
+void fm62429::flush()
+{
+    while (busy()) {
+        tight_loop_contents();
+    }
 }
 
 uint8_t fm62429::get_att_code(const int8_t db)
@@ -44,32 +81,52 @@ uint8_t fm62429::get_att_code(const int8_t db)
     return (att2 << 5) + att1;          // D8 ~ D2
 }
 
-void fm62429::send_code(const uint16_t code)
+void fm62429::send_code(const uint8_t slot, const uint16_t code)
+{
+    PERF_SCOPE(FM62429_SEND);
+    critical_section_enter_blocking(&_crit_sec);
+    if (slot == SLOT_BOTH) {
+        // the write to both channels supersedes the pending writes to each channel
+        for (int i = 0; i < NUM_CH; i++) {
+            if (_pending[i] != NO_CODE) {
+                _pending[i] = NO_CODE;
+                _num_coalesced++;
+            }
+        }
+    }
+    if (_pending[slot] != NO_CODE) { _num_coalesced++; }
+    _pending[slot] = code;
+    _pump();
+    critical_section_exit(&_crit_sec);
+}
+
+void fm62429::_pump()
 {
-    // Caution: gpio logic is opposite to actual signal due to inverter by external MOSFET
-    // initial status
-    gpio_put(_pin_clock, true);
-    gpio_put(_pin_data, true);
-    sleep_us(QUARTER_CYC_US*4);
-    // data bits 0 ~ 9
-    for (int i = 0; i < 10; i++) {
-        gpio_put(_pin_data, ~(code >> i) & 0b1);
-        sleep_us(QUARTER_CYC_US);
-        gpio_put(_pin_clock, false);
-        sleep_us(QUARTER_CYC_US);
-        gpio_put(_pin_data, true);
-        sleep_us(QUARTER_CYC_US);
-        gpio_put(_pin_clock, true);
-        sleep_us(QUARTER_CYC_US);
+    // called in critical section
+    if (_in_flight) { return; }
+    // the write to both channels first, because it is older than the pending writes to each channel
+    static constexpr uint8_t ORDER[NUM_SLOTS] = {SLOT_BOTH, 0, 1};
+    for (const uint8_t slot : ORDER) {
+        if (_pending[slot] != NO_CODE) {
+            // Caution: gpio logic is opposite to actual signal due to inverter by external MOSFET
+            pio_sm_put(_pio, _sm, ~static_cast<uint32_t>(_pending[slot]) & 0x7ff);
+            _pending[slot] = NO_CODE;
+            _in_flight = true;
+            return;
+        }
     }
-    // data bits 10
-    gpio_put(_pin_data, ~(code >> 10) & 0b1);
-    sleep_us(QUARTER_CYC_US);
-    gpio_put(_pin_clock, false);
-    sleep_us(QUARTER_CYC_US);
-    gpio_put(_pin_data, false);
-    sleep_us(QUARTER_CYC_US);
-    gpio_put(_pin_clock, true);
-    sleep_us(QUARTER_CYC_US);
-    gpio_put(_pin_data, true);
-}
\ No newline at end of file
+}
+
+void fm62429::_irq_handler()
+{
+    fm62429* self = _instance;
+    if (self == nullptr || !pio_interrupt_get(self->_pio, self->_sm)) { return; }
+    pio_interrupt_clear(self->_pio, self->_sm);
+    if (self->_done_callback != nullptr) {
+        self->_done_callback();
+    }
+    critical_section_enter_blocking(&self->_crit_sec);
+    self->_in_flight = false;
+    self->_pump();
+    critical_section_exit(&self->_crit_sec);
+}
@@ -7,10 +7,23 @@
 #pragma once
 
 #include "pico/stdlib.h"
+#include "pico/critical_section.h"
+#include "hardware/pio.h"
 
+/**
+* FM62429 / M62429 attenuator driven by PIO
+*
+* A frame (11 bits, about 480 us) is clocked out by a PIO state machine, so set_att() and
+* set_att_both() return immediately. Only one frame is handed to PIO at a time and the
+* rest waits in a pending slot of each target (L, R and both). A write to a target whose
+* previous write is still pending overwrites it (coalescing), and a write to both channels
+* drops the pending writes to each channel. The next frame is handed by PIO IRQ at the end
+* of each frame.
+*/
 class fm62429
 {
 public:
+    typedef void (*done_callback_t)();  // called from PIO IRQ at the end of each frame
     static constexpr int8_t DB_MAX = 0;
     static constexpr int8_t DB_MIN = -83;
 
@@ -20,10 +33,11 @@ public:
     * @param pin_clock GPIO pin number for clock
     * @param pin_data GPIO pin number for data
     */
-    fm62429(const uint pin_clock, const uint pin_data) : _pin_clock(pin_clock), _pin_data(pin_data) {}
+    fm62429(const uint pin_clock, const uint pin_data);
 
     /**
-    * @brief initialization of fm62429
+    * @brief initialization of fm62429 (claim PIO state machine and IRQ)
+    *        set_att() and set_att_both() can be called from either core and IRQ
     *
     */
     void init();
@@ -43,11 +57,51 @@ public:
     */
     void set_att_both(const int8_t db);
 
+    /**
+    * @brief check if any write is pending or in transmission
+    *
+    * @return true if any write is pending or in transmission
+    */
+    bool busy() const;
+
+    /**
+    * @brief wait until all the writes are sent
+    *
+    */
+    void flush();
+
+    /**
+    * @brief set the callback at the end of each frame (when the attenuation takes effect)
+    *
+    * @param callback the callback function (nullptr to disable)
+    */
+    void set_done_callback(done_callback_t callback) { _done_callback = callback; }
+
+    /**
+    * @brief get the number of writes overwritten by later writes before being sent
+    *
+    * @return the number of coalesced writes
+    */
+    uint32_t get_num_coalesced() const { return _num_coalesced; }
+
 private:
     static constexpr uint8_t NUM_CH = 2;
+    static constexpr uint8_t SLOT_BOTH = NUM_CH;  // pending slots: ch0, ch1 and both
+    static constexpr uint8_t NUM_SLOTS = NUM_CH + 1;
+    static constexpr int32_t NO_CODE = -1;
     static constexpr uint64_t QUARTER_CYC_US = 10;
+    static fm62429* _instance;
     const uint _pin_clock;
     const uint _pin_data;
+    PIO _pio;
+    uint _sm;
+    volatile int32_t _pending[NUM_SLOTS];
+    volatile bool _in_flight;
+    uint32_t _num_coalesced;
+    critical_section_t _crit_sec;
+    done_callback_t _done_callback;
     uint8_t get_att_code(const int8_t db);
-    void send_code(const uint16_t code);
+    void send_code(const uint8_t slot, const uint16_t code);
+    void _pump();
+    static void _irq_handler();
 };
\ No newline at end of file
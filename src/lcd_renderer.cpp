@@ -0,0 +1,246 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "lcd_renderer.h"
+
+#include <cstring>
+
+#include "hardware/dma.h"
+#include "lcd_extra.h"
+#include "perf_stats.h"
+
+static constexpr int FONT_W = 8;  // width of character drawn by LCD_ShowString
+
+lcd_renderer::lcd_renderer(spi_inst_t* spi, const uint pin_cs, const uint pin_dc, const uint16_t back_color) :
+    _spi(spi), _pin_cs(pin_cs), _pin_dc(pin_dc), _back_color(back_color), _dma_chan(-1),
+    _num_bars(0), _num_cells(0), _num_rects(0), _cur_rect(0), _state(state_t::IDLE), _num_bytes(0)
+{
+}
+
+void lcd_renderer::init()
+{
+    _dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config cfg = dma_channel_get_default_config(_dma_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, spi_get_dreq(_spi, true));
+    dma_channel_configure(_dma_chan, &cfg,
+        &spi_get_hw(_spi)->dr,  // dst
+        _pixels,                // src (set at each rectangle)
+        0,                      // transfer count (set at each rectangle)
+        false                   // start immediately
+    );
+}
+
+int lcd_renderer::add_bar(const orientation_t orient, const int x, const int y, const int w, const int h, const int pitch, const int num_segments)
+{
+    if (_num_bars >= MAX_BARS || num_segments > MAX_SEGMENTS) { return -1; }
+    bar_t& b = _bars[_num_bars];
+    b.orient = orient;
+    b.x = x;
+    b.y = y;
+    b.w = w;
+    b.h = h;
+    b.pitch = pitch;
+    b.num_segments = num_segments;
+    for (int i = 0; i < MAX_SEGMENTS; i++) {
+        b.color[i] = INVALID_COLOR;
+    }
+    b.dirty_lo = num_segments;
+    b.dirty_hi = -1;
+    return _num_bars++;
+}
+
+void lcd_renderer::set_text(const int x, const int y, const char* str, const uint16_t color)
+{
+    for (int k = 0; str[k] != '\0'; k++) {
+        const int cx = x + FONT_W * k;
+        text_cell_t* cell = nullptr;
+        for (int i = 0; i < _num_cells; i++) {
+            if (_cells[i].x == cx && _cells[i].y == y) {
+                cell = &_cells[i];
+                break;
+            }
+        }
+        if (cell == nullptr) {
+            if (_num_cells >= MAX_TEXT_CELLS) { return; }
+            cell = &_cells[_num_cells++];
+            cell->x = cx;
+            cell->y = y;
+            cell->drawn = ' ';  // blank screen
+            cell->color = color;
+        }
+        if (cell->color != color) {
+            cell->color = color;
+            cell->drawn = '\0';  // force to redraw
+        }
+        cell->set = str[k];
+    }
+}
+
+void lcd_renderer::invalidate()
+{
+    for (int i = 0; i < _num_bars; i++) {
+        bar_t& b = _bars[i];
+        for (int k = 0; k < MAX_SEGMENTS; k++) {
+            b.color[k] = INVALID_COLOR;
+        }
+        b.dirty_lo = b.num_segments;
+        b.dirty_hi = -1;
+    }
+    for (int i = 0; i < _num_cells; i++) {
+        _cells[i].set = ' ';
+        _cells[i].drawn = ' ';
+    }
+}
+
+int lcd_renderer::_render_bar(bar_t& b, int ofs)
+{
+    // merge the dirty segments into one rectangle (as many segments as the buffer allows)
+    const int room = MAX_PIXELS - ofs / 2;
+    const int lo = b.dirty_lo;
+    int hi = b.dirty_hi;
+    rect_t& r = _rects[_num_rects];
+    auto color_of = [&](const int k) {
+        return (b.color[k] == INVALID_COLOR) ? _back_color : static_cast<uint16_t>(b.color[k]);
+    };
+    if (b.orient == orientation_t::HORIZONTAL) {
+        while (hi >= lo && ((hi - lo) * b.pitch + b.w) * b.h > room) { hi--; }
+        if (hi < lo) { return 0; }
+        r.x1 = b.x + lo * b.pitch;
+        r.x2 = b.x + hi * b.pitch + b.w - 1;
+        r.y1 = b.y;
+        r.y2 = b.y + b.h - 1;
+        // first row, then copy to the other rows
+        const int width = r.x2 - r.x1 + 1;
+        uint8_t* row = &_pixels[ofs];
+        for (int px = 0; px < width; px++) {
+            const int k = lo + px / b.pitch;
+            const uint16_t c = (px % b.pitch < b.w) ? color_of(k) : _back_color;
+            row[px * 2]     = c >> 8;
+            row[px * 2 + 1] = c & 0xff;
+        }
+        for (int py = 1; py < b.h; py++) {
+            memcpy(&row[py * width * 2], row, width * 2);
+        }
+    } else {
+        while (hi >= lo && ((hi - lo) * b.pitch + b.h) * b.w > room) { hi--; }
+        if (hi < lo) { return 0; }
+        r.x1 = b.x;
+        r.x2 = b.x + b.w - 1;
+        r.y1 = b.y - hi * b.pitch;
+        r.y2 = b.y - lo * b.pitch + b.h - 1;
+        // rows from the top (segment hi) to the bottom (segment lo)
+        const int height = r.y2 - r.y1 + 1;
+        uint8_t* p = &_pixels[ofs];
+        for (int py = 0; py < height; py++) {
+            const int k = hi - py / b.pitch;
+            const uint16_t c = (py % b.pitch < b.h) ? color_of(k) : _back_color;
+            for (int px = 0; px < b.w; px++) {
+                *p++ = c >> 8;
+                *p++ = c & 0xff;
+            }
+        }
+    }
+    r.ofs = ofs;
+    _num_rects++;
+    // the rest is left for next flush
+    if (hi == b.dirty_hi) {
+        b.dirty_lo = b.num_segments;
+        b.dirty_hi = -1;
+    } else {
+        b.dirty_lo = hi + 1;
+    }
+    return (r.x2 - r.x1 + 1) * (r.y2 - r.y1 + 1) * 2;
+}
+
+bool lcd_renderer::flush()
+{
+    if (_state != state_t::IDLE) { return false; }
+    PERF_SCOPE(LCD_FLUSH);
+    _num_rects = 0;
+    int ofs = 0;
+    for (int i = 0; i < _num_bars; i++) {
+        bar_t& b = _bars[i];
+        if (b.dirty_hi < b.dirty_lo) { continue; }
+        const int bytes = _render_bar(b, ofs);
+        if (bytes == 0) { break; }  // buffer is full
+        ofs += bytes;
+    }
+    if (_num_rects > 0) {
+        _cur_rect = 0;
+        _state = state_t::RECT;
+        _start_rect(_rects[0]);
+    } else {
+        _state = state_t::TEXT;
+    }
+    return true;
+}
+
+void lcd_renderer::_start_rect(const rect_t& r)
+{
+    // LCD library sends window commands (blocking, a few bytes), then pixels are sent by DMA
+    LCD_Address_Set(r.x1, r.y1, r.x2, r.y2);
+    gpio_put(_pin_dc, 1);
+    gpio_put(_pin_cs, 0);
+    const uint32_t bytes = (r.x2 - r.x1 + 1) * (r.y2 - r.y1 + 1) * 2;
+    dma_channel_set_read_addr(_dma_chan, &_pixels[r.ofs], false);
+    dma_channel_set_trans_count(_dma_chan, bytes, true);
+    _num_bytes += bytes;
+}
+
+void lcd_renderer::_end_rect()
+{
+    gpio_put(_pin_cs, 1);
+    // discard received data and clear overrun (only TX is handled by DMA)
+    while (spi_is_readable(_spi)) {
+        (void) spi_get_hw(_spi)->dr;
+    }
+    spi_get_hw(_spi)->icr = SPI_SSPICR_RORIC_BITS;
+}
+
+void lcd_renderer::poll()
+{
+    switch (_state) {
+    case state_t::RECT:
+        if (dma_channel_is_busy(_dma_chan) || spi_is_busy(_spi)) { return; }
+        _end_rect();
+        if (++_cur_rect < _num_rects) {
+            _start_rect(_rects[_cur_rect]);
+            return;
+        }
+        _state = state_t::TEXT;
+        [[fallthrough]];
+    case state_t::TEXT:
+        // one changed character for each poll
+        for (int i = 0; i < _num_cells; i++) {
+            text_cell_t& cell = _cells[i];
+            if (cell.set != cell.drawn) {
+                const char str[2] = {cell.set, '\0'};
+                LCD_ShowString(cell.x, cell.y, reinterpret_cast<const u8*>(str), cell.color);
+                cell.drawn = cell.set;
+                return;
+            }
+        }
+        _state = state_t::IDLE;
+        break;
+    default:
+        break;
+    }
+}
+
+bool lcd_renderer::busy() const
+{
+    return _state != state_t::IDLE;
+}
+
+void lcd_renderer::wait()
+{
+    while (busy()) {
+        poll();
+    }
+}
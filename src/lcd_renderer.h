@@ -0,0 +1,192 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+
+/**
+* retained-mode renderer of segment bars and text cells for ST7735S LCD
+*
+* The last drawn color of each segment and the last drawn character of each text cell
+* are retained, and only the changed ones are sent to LCD. The changed segments of a bar
+* are merged into one rectangle, which is sent by one DMA transfer to SPI.
+* flush() and poll() never wait for SPI, so that the main loop is not blocked.
+* Text cells are drawn by LCD library after the rectangles (only when changed).
+*/
+class lcd_renderer
+{
+public:
+    static constexpr int MAX_BARS = 24;
+    static constexpr int MAX_SEGMENTS = 32;
+    static constexpr int MAX_TEXT_CELLS = 16;
+    static constexpr int MAX_RECTS = MAX_BARS;
+    static constexpr int MAX_PIXELS = 4096;  // pixel buffer (2 bytes / pixel)
+
+    enum class orientation_t {
+        HORIZONTAL,  // segments from left to right
+        VERTICAL     // segments from bottom to top
+    };
+
+    /**
+    * @brief constructor of lcd_renderer
+    *
+    * @param spi SPI instance connected to LCD
+    * @param pin_cs GPIO pin number for CS of LCD
+    * @param pin_dc GPIO pin number for DC of LCD
+    * @param back_color background color between segments
+    */
+    lcd_renderer(spi_inst_t* spi, const uint pin_cs, const uint pin_dc, const uint16_t back_color);
+
+    /**
+    * @brief initialization of lcd_renderer (claim DMA channel)
+    *
+    */
+    void init();
+
+    /**
+    * @brief add a bar of segments
+    *
+    * @param orient orientation of the bar
+    * @param x x of the first segment (left)
+    * @param y y of the first segment (top)
+    * @param w width of a segment
+    * @param h height of a segment
+    * @param pitch interval of segments (including gap)
+    * @param num_segments the number of segments (up to MAX_SEGMENTS)
+    * @return bar id (-1 if no room)
+    */
+    int add_bar(const orientation_t orient, const int x, const int y, const int w, const int h, const int pitch, const int num_segments);
+
+    /**
+    * @brief set color of a segment (drawn at next flush if changed)
+    *
+    * @param bar bar id
+    * @param idx segment index
+    * @param color color of the segment
+    */
+    inline void set_segment(const int bar, const int idx, const uint16_t color)
+    {
+        bar_t& b = _bars[bar];
+        if (b.color[idx] == color) { return; }
+        b.color[idx] = color;
+        if (idx < b.dirty_lo) { b.dirty_lo = idx; }
+        if (idx > b.dirty_hi) { b.dirty_hi = idx; }
+    }
+
+    /**
+    * @brief set colors of a bar as a meter (drawn at next flush if changed)
+    *        segment i is on if i == 0 (always on), i < level or i == peak_hold
+    *
+    * @param bar bar id
+    * @param level the number of segments on from the bottom
+    * @param peak_hold segment index of peak hold (-1: none)
+    * @param colors color of each segment when on
+    * @param off_color color of the segments when off
+    */
+    inline void set_bar(const int bar, const int level, const int peak_hold, const uint16_t colors[], const uint16_t off_color)
+    {
+        const int num = _bars[bar].num_segments;
+        for (int i = 0; i < num; i++) {
+            set_segment(bar, i, (i == 0 || i < level || i == peak_hold) ? colors[i] : off_color);
+        }
+    }
+
+    /**
+    * @brief set text (changed characters are drawn at next flush)
+    *
+    * @param x x of the first character
+    * @param y y of the first character
+    * @param str string
+    * @param color color of the text
+    */
+    void set_text(const int x, const int y, const char* str, const uint16_t color);
+
+    /**
+    * @brief forget the drawn state (call after the screen is cleared by LCD library)
+    *        all the text cells are regarded as blank
+    */
+    void invalidate();
+
+    /**
+    * @brief start sending the changed rectangles (returns immediately)
+    *
+    * @return false if the previous flush is still in progress (changes are kept for next flush)
+    */
+    bool flush();
+
+    /**
+    * @brief advance the transfer of flush (call frequently from main loop)
+    *
+    */
+    void poll();
+
+    /**
+    * @brief check if flush is in progress
+    *
+    * @return true if flush is in progress
+    */
+    bool busy() const;
+
+    /**
+    * @brief wait until flush completes (call before using LCD library directly)
+    *
+    */
+    void wait();
+
+    /**
+    * @brief get the number of bytes sent to LCD by DMA
+    *
+    * @return the number of bytes
+    */
+    uint32_t get_num_bytes() const { return _num_bytes; }
+
+private:
+    static constexpr uint32_t INVALID_COLOR = 0xffffffff;
+    typedef struct _bar_t {
+        orientation_t orient;
+        int x, y, w, h, pitch;
+        int num_segments;
+        uint32_t color[MAX_SEGMENTS];  // last set color (INVALID_COLOR: unknown)
+        int dirty_lo, dirty_hi;
+    } bar_t;
+    typedef struct _rect_t {
+        int x1, y1, x2, y2;  // inclusive
+        int ofs;             // offset in pixel buffer (bytes)
+    } rect_t;
+    typedef struct _text_cell_t {
+        int x, y;
+        char set;    // character to draw
+        char drawn;  // character on LCD
+        uint16_t color;
+    } text_cell_t;
+    enum class state_t {
+        IDLE,
+        RECT,  // DMA transfer of a rectangle
+        TEXT
+    };
+
+    spi_inst_t* _spi;
+    const uint _pin_cs;
+    const uint _pin_dc;
+    const uint16_t _back_color;
+    int _dma_chan;
+    bar_t _bars[MAX_BARS];
+    int _num_bars;
+    text_cell_t _cells[MAX_TEXT_CELLS];
+    int _num_cells;
+    rect_t _rects[MAX_RECTS];
+    int _num_rects;
+    int _cur_rect;
+    uint8_t _pixels[MAX_PIXELS * 2];
+    state_t _state;
+    uint32_t _num_bytes;
+
+    int _render_bar(bar_t& b, int ofs);
+    void _start_rect(const rect_t& r);
+    void _end_rect();
+};
@@ -6,53 +6,140 @@
 
 #include "level_meter.h"
 
-#include <cstdio>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 
 #include "pico/stdlib.h"
-#include "pico/util/queue.h"
+#include "pico/flash.h"
+#if PICO_LEVEL_METER_CORE1
+#include "pico/multicore.h"
+#endif
 #include "hardware/adc.h"
-#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
 #include "hardware/irq.h"
-#include "hardware/pwm.h"
 
-#include "conv_dB_level.h"
+#include "adc_capture.h"
+#include "cic_decimator.h"
+#include "loudness.h"
+#include "stereo.h"
+#include "meter_engine.h"
+#include "perf_stats.h"
+#include "spectrum.h"
+#include "true_peak.h"
 
 namespace level_meter
 {
 
-#define DMA_IRQ_x __CONCAT(DMA_IRQ_, PICO_LEVEL_METER_DMA_IRQ)
-
 static constexpr uint PIN_ADC_BASE    = 26;  // determined by rp2040 (don't change this)
-static constexpr int  ADC_BUF_LEN     = 10 * NUM_ADC_CH;
-
-static uint     dma_chan[2];  // double buffer
-static int      buf_idx = 0;
-static uint16_t dma_buf[2][ADC_BUF_LEN];
-static int      dma_irq_count = 0;
-
-static dma_channel_config cfg[2];
-
-static constexpr int ADC_BITS = 12;
-static constexpr int ADC_MAX = (1 << ADC_BITS) - 1;
-// RANGE_RATIO: 900mV / 3300mV
-//   This is determined by the OPAMP hardware circuit
-//   under maximum FM62429 input level without distortion
-static constexpr float RANGE_RATIO = 900.0f / 3300;
-static constexpr float ADC_CALIB_ZERO_MARGIN = 1.6;
-static float ADC_CALIB_A[NUM_ADC_CH];
-static float ADC_CALIB_B[NUM_ADC_CH];
-
-// dB level conversion
-level_meter::conv_dB_level *dBLevel;
-
-static queue_t _level_queue;
-static constexpr uint LEVEL_QUEUE_LENGTH = 4;
-typedef struct _level_item_t {
-    int id;
-    int rawValue[NUM_ADC_CH];
-    int level[NUM_ADC_CH];
-} level_item_t;
+static constexpr int  ADC_BUF_FRAMES  = MAX_BLOCK_FRAMES;  // frames of the largest block (buffers are sized by it)
+static constexpr int  ADC_BUF_LEN     = ADC_BUF_FRAMES * NUM_ADC_CH;
+static constexpr int  NUM_ADC_BUF     = PICO_LEVEL_METER_NUM_BLOCKS;
+static constexpr int  ADC_OVERSAMPLE  = PICO_LEVEL_METER_OVERSAMPLE;
+static constexpr int  ADC_RAW_LEN     = ADC_BUF_LEN * ADC_OVERSAMPLE;  // samples in the largest block captured by DMA
+static_assert(ADC_RAW_LEN == MAX_BLOCK_RAW_LEN, "ADC_RAW_LEN must be MAX_BLOCK_RAW_LEN");
+
+// block size of the selected profile (fixed after init())
+static block_profile_t blockProfile = block_profile_t::STANDARD;
+static int blockFrames = BLOCK_FRAMES;                             // frames per block (after decimation)
+static int blockRawLen = BLOCK_FRAMES * NUM_ADC_CH * ADC_OVERSAMPLE;  // samples in a block captured by DMA
+
+static uint16_t dma_buf[NUM_ADC_BUF * ADC_RAW_LEN];  // ring of blocks filled by adc_capture (blockRawLen each)
+static uint32_t sampleRate = DEFAULT_SAMPLE_RATE;    // per channel (after decimation)
+
+// block seq in the DMA ring
+static inline const uint16_t* _dma_block(const uint32_t seq)
+{
+    return &dma_buf[(seq & (NUM_ADC_BUF - 1)) * blockRawLen];
+}
+
+// latency from the first sample of a block to the end of its processing (in captured samples of all channels)
+static std::atomic<uint32_t> latencyMin{UINT32_MAX};
+static std::atomic<uint32_t> latencyMax{0};
+static std::atomic<uint32_t> latencySum{0};     // saturated, and then the later blocks are left out of the average
+static std::atomic<uint32_t> latencyCount{0};   // blocks in latencySum
+static std::atomic<bool> latencySaturated{false};
+
+// metering engine of the channels (calibration, decimation, ballistics, dB level conversion and peak hold)
+//   the level is computed from the high resolution samples with oversampling, and the others take the samples rounded to ADC code
+static constexpr float RANGE_RATIO = static_cast<float>(RANGE_RATIO_NUM) / RANGE_RATIO_DEN;
+using engine_t = meter_engine<NUM_ADC_CH, ADC_BUF_FRAMES, ADC_OVERSAMPLE, ADC_BITS>;
+static_assert(engine_t::RAW_LEN == ADC_RAW_LEN, "engine_t::RAW_LEN must be ADC_RAW_LEN");
+static engine_t engine(RANGE_RATIO);
+using trimmed_mean_t = engine_t::trimmed_mean_t;
+
+static constexpr int ADC_MAX = engine_t::ADC_MAX;
+static constexpr int CODE_FRAC = engine_t::CODE_FRAC;  // fractional bits of code for dB level conversion
+static constexpr int ADC_CALIB_ZERO_MARGIN_NUM = 8;  // 1.6
+static constexpr int ADC_CALIB_ZERO_MARGIN_DEN = 5;
+static std::atomic<meter_mode_t> meterMode{meter_mode_t::TRIMMED_MEAN};
+
+// true-peak (4x oversampling)
+static constexpr int32_t FULL_SCALE_CODE = ADC_MAX * RANGE_RATIO_NUM / RANGE_RATIO_DEN;  // top of dB scale
+static true_peak truePeakCh[NUM_ADC_CH];
+static std::atomic<bool> truePeakEnable{false};
+static std::atomic<int32_t> truePeakMax[NUM_ADC_CH];     // maximum since last get_true_peak()
+static std::atomic<uint32_t> truePeakOvers[NUM_ADC_CH];  // sticky until clear_overs()
+
+// loudness (EBU R128)
+static loudness loudnessMeter(NUM_ADC_CH, FULL_SCALE_CODE);
+static std::atomic<bool> loudnessEnable{false};
+static std::atomic<bool> loudnessResetReq{false};  // reset is done in block processing
+
+// stereo correlation, balance and mid/side (first 2 channels)
+static stereo stereoMeter((NUM_ADC_CH >= 2) ? NUM_ADC_CH : 2, FULL_SCALE_CODE);
+static std::atomic<bool> stereoEnable{false};
+static std::atomic<bool> stereoResetReq{false};  // reset is done in block processing
+
+// spectrum analyser (FFT runs in the lowest priority user IRQ on the processing core)
+static spectrum spectrumMeter(NUM_ADC_CH);
+static std::atomic<bool> spectrumEnable{false};
+static uint32_t spectrumRate = DEFAULT_SPECTRUM_RATE;
+static int spectrumIrq = -1;
+typedef struct _spectrum_item_t {
+    int level[NUM_BANDS];
+} spectrum_item_t;
+static spsc_ring<spectrum_item_t, 2> _spectrum_queue;  // user IRQ -> get_spectrum()
+
+// auto-ranging by the attenuator in front of ADC
+//   The level is compensated by the attenuation from the sample at which the attenuator switched,
+//   and the samples during settling are skipped. True-peak, loudness and spectrum are referenced
+//   to the full scale at the maximum attenuation, and take the range at block boundary.
+static constexpr int32_t RANGE_HIGH_CODE = ADC_MAX * 15 / 16;         // to more attenuation (near clipping)
+static constexpr int32_t RANGE_LOW_CODE = RANGE_HIGH_CODE * 178 / 1000;  // to less attenuation (-15 dB: step + 3 dB hysteresis)
+static constexpr uint32_t RANGE_SETTLE_US = 500;  // samples skipped after switching
+static constexpr uint32_t RANGE_HOLD_MS = 500;    // duration below RANGE_LOW_CODE to switch to less attenuation
+static constexpr uint32_t RANGE_TIMEOUT_MS = 20;  // regarded as switched without notification
+static std::atomic<bool> rangeEnable{false};
+static range_handler_t rangeHandler = nullptr;
+static bool rangeActive = false;
+static int32_t rangeGain[NUM_RANGES];                 // compensation of each range (Q8, 256 at 0 dB)
+static uint32_t rangeThreshold[MAX_RANGE_LEVELS];    // dB scale in compensated code (Q8)
+static int rangeNumLevels = 0;
+static int rangeCur;       // range applied to the samples
+static int rangeReq;       // requested range (same as rangeCur if none)
+static uint32_t rangeReqSeq;
+static std::atomic<bool> rangeSwitched{false};
+static std::atomic<uint32_t> rangeSwitchPos;  // sample position (adc_capture::get_position) at switching
+static std::atomic<int> rangeAttDb{0};
+static uint32_t rangeSettleFrames;  // RANGE_SETTLE_US in frames at current sampling rate
+static uint32_t rangeHoldBlocks;    // RANGE_HOLD_MS in blocks
+static uint32_t rangeTimeoutBlocks; // RANGE_TIMEOUT_MS in blocks
+static uint32_t rangeSkipFrames;    // the rest of settling
+static uint32_t rangeLowBlocks;     // consecutive blocks below RANGE_LOW_CODE
+static int32_t rangeCode[NUM_ADC_CH];  // compensated code of the last block (held during settling)
+static int32_t rangeCalibGain[NUM_ADC_CH];  // calibration including compensation for true-peak, loudness and spectrum
+static int32_t rangeCalibOfs[NUM_ADC_CH];
+
+// dB level conversion (the lookup table is held by engine)
+level_meter::conv_dB_level *dBLevel = nullptr;  // runtime configurable dB scale
+level_meter::conv_dB_level *dBLevelBand = nullptr;  // runtime configurable dB scale for spectrum bands
+
+static constexpr uint LEVEL_QUEUE_LENGTH = PICO_LEVEL_METER_QUEUE_LENGTH;
+static spsc_ring<level_item_t, LEVEL_QUEUE_LENGTH> _level_queue;  // IRQ (core0 or core1) -> get_level()
+static std::atomic<notify_handler_t> notifyHandler{nullptr};  // doorbell to the application
 
 enum class State {
     INIT,
@@ -61,207 +148,1110 @@ enum class State {
 };
 static State state = State::INIT;
 static constexpr int NUM_CALIB_COUNT = 10;
+static constexpr uint32_t CALIB_SETTLE_MS = 100;  // forced zero input settles before calibration
 static int calibCount;
+static int calibSettleBlocks;
+static std::atomic<bool> calibReq{false};
 
-static constexpr int PEAK_HOLD_TIMES = 50;
-static int peak_hold_count[NUM_ADC_CH];
-static int peak_hold_level[NUM_ADC_CH];
+// zero level of ADC input (calibration is derived from it, and stored by application for warm boot)
+//   tracked during silence: all the samples of a block are under the zero margin, their spread is within
+//   ZERO_TRACK_SPREAD and their mean is within ZERO_TRACK_LIMIT from the zero at calibration
+static constexpr int ZERO_FRAC = 8;  // fractional bits of zero level
+static constexpr int32_t ZERO_TRACK_SPREAD = 8;   // in ADC code
+static constexpr int32_t ZERO_TRACK_LIMIT = 16;   // in ADC code
+static constexpr int ZERO_TRACK_SHIFT = 8;        // time constant in blocks (256 blocks)
+static std::atomic<int32_t> calibZero[NUM_ADC_CH];  // Q8 of raw ADC code (-1: not calibrated)
+static int32_t calibZeroRef[NUM_ADC_CH];
+static bool calibPreset = false;  // calibration given by set_calib_zero()
+
+// trace of raw blocks (recorded in block processing, replayed in place of capture)
+//   the state of block processing is reset at the start block, and the events which change
+//   the processing of a block (requests from the other contexts) are recorded with the block
+typedef struct _trace_item_t {
+    trace::block_t block;
+    uint16_t raw[ADC_RAW_LEN];
+} trace_item_t;
+static std::atomic<bool> traceEnable{false};
+static bool traceActive = false;
+static bool traceGap = false;      // the last block was not queued
+static uint8_t traceFlags;         // events of the block in process
+static uint32_t traceSwitchPos;
+static trace::header_t traceHeader;  // state at the start block
+static spsc_ring<trace_item_t, PICO_LEVEL_METER_TRACE_LENGTH> _trace_queue(overflow_policy_t::DROP_NEWEST);  // IRQ -> get_trace_frame()
+
+// telemetry of level items (every block, sent by application only when serial has room)
+//   the items are dropped in IRQ while the queue is full, so that serial never stalls block processing
+static_assert(NUM_ADC_CH <= telemetry::MAX_CH, "NUM_ADC_CH must be up to telemetry::MAX_CH");
+static std::atomic<bool> telemetryEnable{false};
+static int telemetryBatch = DEFAULT_TELEMETRY_BATCH;
+static spsc_ring<level_item_t, PICO_LEVEL_METER_TELEMETRY_LENGTH> _telemetry_queue(overflow_policy_t::DROP_NEWEST);  // IRQ -> get_telemetry_frame()
+static level_item_t telemetryItem;      // popped but not fit in the last frame
+static bool telemetryPending = false;
+
+// raw PCM stream of captured blocks sent from the DMA ring in place (application context only)
+//   a block is framed after DMA completes it, and has to be handed to serial before DMA comes back to it.
+//   Otherwise the CRC of the frame is broken on purpose (the receiver drops it) and the block is counted as overrun
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "samples are sent as little endian in place");
+static_assert(pcm::PREFIX_LEN + ADC_RAW_LEN * sizeof(uint16_t) <= wire_frame::MAX_PAYLOAD, "block is too large for a frame");
+enum class pcm_state_t {
+    IDLE,
+    HEADER,
+    SAMPLES,
+    TRAILER
+};
+static bool pcmEnable = false;
+static pcm_state_t pcmState = pcm_state_t::IDLE;
+static uint32_t pcmSeq;               // sequence number of the block to send
+static int pcmPos;                    // bytes sent in the current state
+static uint16_t pcmCrc;
+static uint32_t pcmNumOverruns = 0;
+static uint8_t pcmHeader[wire_frame::HEADER_LEN + pcm::PREFIX_LEN];
+static uint8_t pcmTrailer[2];
 
 // prototype declaration
-static void __isr __time_critical_func(level_meter_dma_irq_handler)();
+static void _init();
+static void _update_rate_dependents();
+static void _spectrum_irq_init();
+static void _reset_processing();
+#if PICO_LEVEL_METER_CORE1
+static void core1_main();
+#endif
+static void __time_critical_func(process_block)(const uint16_t* block, const uint32_t seq);
+static void __time_critical_func(capture_block)(const uint16_t* block, const uint32_t seq);
 
 void init(const std::vector<float>& db_scale)
 {
     // dB level conversion
     dBLevel = new level_meter::conv_dB_level(NUM_ADC_CH, db_scale);
+    dBLevelBand = new level_meter::conv_dB_level(NUM_BANDS, db_scale);
+    engine.set_level_table(nullptr);
+    engine.set_level_conv(dBLevel);
+    _init();
+}
 
-    // ADC setup
+void init(const uint8_t level_table[])
+{
+    // dB level conversion
+    engine.set_level_table(level_table);
+    _init();
+}
+
+void init(const uint8_t level_table[], const uint32_t level_threshold[], const int num_levels)
+{
+    // dB level conversion (thresholds for high resolution code)
+    engine.set_level_table(level_table, level_threshold, num_levels);
+    _init();
+}
+
+static void _apply_zero(const int i, const int32_t zero)
+{
+    // calibration parameters from zero level (in integer to get the same result on host)
+    //   norm = zero / (ADC_MAX * RANGE_RATIO) = a / A_FULL, intercept = -norm * 1.6 (ADC_CALIB_ZERO_MARGIN)
+    //   gain = 1 / (1 + intercept), ofs = intercept * ADC_MAX
+    static constexpr int64_t A_FULL = static_cast<int64_t>(ADC_MAX << ZERO_FRAC) * RANGE_RATIO_NUM;
+    static constexpr int64_t A_MAX = std::min<int64_t>(A_FULL, (A_FULL * ADC_CALIB_ZERO_MARGIN_DEN - 1) / ADC_CALIB_ZERO_MARGIN_NUM);  // gain > 0
+    const int64_t a = std::clamp<int64_t>(static_cast<int64_t>(zero) * RANGE_RATIO_DEN, 0, A_MAX);
+    const int64_t den = A_FULL * ADC_CALIB_ZERO_MARGIN_DEN - a * ADC_CALIB_ZERO_MARGIN_NUM;
+    const int32_t gain = static_cast<int32_t>(engine_t::GAIN_UNITY * A_FULL * ADC_CALIB_ZERO_MARGIN_DEN / den);
+    const int32_t ofs = -static_cast<int32_t>(a * ADC_CALIB_ZERO_MARGIN_NUM * ADC_MAX / (A_FULL * ADC_CALIB_ZERO_MARGIN_DEN));
+    engine.set_calib(i, gain, ofs);
+    calibZero[i].store(zero, std::memory_order_relaxed);
+}
+
+static void _force_zero()
+{
+    // force ADC input signal to zero for calibration (released in block processing)
     for (int i = 0; i < NUM_ADC_CH; i++) {
         uint pin = PIN_ADC_BASE + PIN_ADC_OFFSET + i;
-        adc_gpio_init(pin);
-        // force ADC input signal to zero for calibration
         gpio_init(pin);
         gpio_set_dir(pin, GPIO_OUT);
         gpio_put(pin, 0);
         // reset calibration paramteters
-        calibCount = 0;
-        ADC_CALIB_A[i] = 1.0;
-        ADC_CALIB_B[i] = 0.0;
+        engine.set_calib(i, engine_t::GAIN_UNITY, 0);
+        calibZero[i].store(-1, std::memory_order_relaxed);
     }
+    calibCount = 0;
+}
 
-    adc_init();
+static void _init()
+{
+    // ADC setup
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        uint pin = PIN_ADC_BASE + PIN_ADC_OFFSET + i;
+        adc_gpio_init(pin);
+    }
+    if (!calibPreset) {
+        _force_zero();
+    }
 
-    adc_fifo_setup(
-        true,    // Write each completed conversion to the sample FIFO
-        true,    // Enable DMA data request (DREQ)
-        1,       // DREQ (and IRQ) asserted when at least 1 sample present
-        false,   // We won't see the ERR bit because of 8 bit reads; disable.
-        false    // Not shift each sample to 8 bits when pushing to FIFO
-    );
+    adc_capture::set_sample_rate(sampleRate * NUM_ADC_CH * ADC_OVERSAMPLE);
+    _update_rate_dependents();
+    adc_capture::init(((1 << NUM_ADC_CH) - 1) << PIN_ADC_OFFSET, dma_buf, blockRawLen, NUM_ADC_BUF, capture_block);
 
-    adc_set_clkdiv(96*500);  // sampling rate 1 KHz (48MHz x cycle)
-    adc_set_round_robin(((1 << NUM_ADC_CH) - 1) << PIN_ADC_OFFSET);  // set bits to used
+    // DMA IRQ (IRQ handler runs on the core which enables it)
+#if PICO_LEVEL_METER_CORE1
+    multicore_launch_core1(core1_main);
+    multicore_fifo_pop_blocking();  // wait for core1 to get ready
+#else
+    adc_capture::irq_init();
+    _spectrum_irq_init();
+#endif
 
-    sleep_ms(100);
+    // State to calibration (skipped with the stored zero level)
+    state = calibPreset ? State::RUNNING : State::CALIBRATION;
+}
 
-    // Set up the DMA to start transferring data as soon as it appears in FIFO
-    dma_chan[0] = dma_claim_unused_channel(true);
-    dma_chan[1] = dma_claim_unused_channel(true);
-    for (int i = 0; i < 2; i++) {
-        cfg[i] = dma_channel_get_default_config(dma_chan[i]);
-        channel_config_set_transfer_data_size(&cfg[i], DMA_SIZE_16);
-        // Reading from constant address, writing to incrementing byte addresses
-        channel_config_set_read_increment(&cfg[i], false);
-        channel_config_set_write_increment(&cfg[i], true);
-        channel_config_set_dreq(&cfg[i], DREQ_ADC); // Pace transfers based on availability of ADC samples
-        channel_config_set_chain_to(&cfg[i], dma_chan[1 - i]);
+#if PICO_LEVEL_METER_CORE1
+static void core1_main()
+{
+    perf_stats::init();
+    flash_safe_execute_core_init();  // locked out in RAM during flash access from core0
+    adc_capture::irq_init();
+    _spectrum_irq_init();
+    multicore_fifo_push_blocking(0);  // notify core0 of ready
+    // all the signal processing is done in DMA IRQ on this core
+    while (true) {
+        __wfi();
     }
+}
+#endif
 
-    // DMA IRQ
-    if (!irq_has_shared_handler(DMA_IRQ_x)) {
-        irq_add_shared_handler(DMA_IRQ_x, level_meter_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
-    }
-    dma_irqn_set_channel_enabled(PICO_LEVEL_METER_DMA_IRQ, dma_chan[0], true);
-    dma_irqn_set_channel_enabled(PICO_LEVEL_METER_DMA_IRQ, dma_chan[1], true);
-    irq_set_enabled(DMA_IRQ_x, true);
+void set_sample_rate(const uint32_t rate)
+{
+    adc_capture::set_sample_rate(rate * NUM_ADC_CH * ADC_OVERSAMPLE);
+    sampleRate = adc_capture::get_sample_rate() / (NUM_ADC_CH * ADC_OVERSAMPLE);
+    _update_rate_dependents();
+}
 
-    for (int i = 0; i < 2; i++) {
-        dma_channel_configure(dma_chan[i], &cfg[i],
-            dma_buf[i],  // dst
-            &adc_hw->fifo,   // src
-            ADC_BUF_LEN,   // transfer count
-            false            // start immediately
-        );
-    }
+static void _update_rate_dependents()
+{
+    // ballistics coefficients of all modes (applied in block processing at mode change) and peak hold time
+    engine.set_block_frames(blockFrames);
+    engine.set_sample_rate(sampleRate, meterMode.load());
+    // K-weighting and window length of loudness
+    loudnessMeter.set_sample_rate(sampleRate);
+    // update interval of stereo analysis
+    stereoMeter.set_sample_rate(sampleRate);
+    // frame interval of spectrum analyser
+    spectrumMeter.set_interval(sampleRate / spectrumRate);
+    const uint64_t frame_cycles = static_cast<uint64_t>(clock_get_hz(clk_sys)) / spectrumRate;
+    perf_stats::set_deadline(perf_stats::SPECTRUM, static_cast<uint32_t>(frame_cycles));
+    // timing of auto-ranging
+    rangeSettleFrames = (RANGE_SETTLE_US * sampleRate + 999999) / 1000000;
+#if PICO_LEVEL_METER_OVERSAMPLE > 1
+    rangeSettleFrames += cic_decimator<PICO_LEVEL_METER_OVERSAMPLE>::SPAN;  // a step spreads over the impulse response
+#endif
+    rangeHoldBlocks = std::max<uint32_t>(RANGE_HOLD_MS * sampleRate / (1000 * blockFrames), 1);
+    rangeTimeoutBlocks = std::max<uint32_t>(RANGE_TIMEOUT_MS * sampleRate / (1000 * blockFrames), 2);
+    // settling of forced zero input in blocks
+    calibSettleBlocks = static_cast<int>(CALIB_SETTLE_MS * sampleRate / (1000 * blockFrames));
+    // block processing should finish before the next block arrives
+    const uint64_t cycles = static_cast<uint64_t>(clock_get_hz(clk_sys)) * blockFrames / sampleRate;
+    perf_stats::set_deadline(perf_stats::PROCESS_BLOCK, static_cast<uint32_t>(cycles));
+}
 
-    // Queue setup
-    queue_init(&_level_queue, sizeof(level_item_t), LEVEL_QUEUE_LENGTH);
+void set_block_profile(const block_profile_t profile)
+{
+    if (state != State::INIT || profile >= block_profile_t::NUM_PROFILES) { return; }
+    blockProfile = profile;
+    blockFrames = PROFILE_FRAMES[static_cast<int>(profile)];
+    blockRawLen = blockFrames * NUM_ADC_CH * ADC_OVERSAMPLE;
+    _update_rate_dependents();
+}
 
-    // State to calibration
-    state = State::CALIBRATION;
+block_profile_t get_block_profile()
+{
+    return blockProfile;
 }
 
-void start()
+int get_block_frames()
+{
+    return blockFrames;
+}
+
+void set_mode(const meter_mode_t mode)
+{
+    meterMode.store(mode);
+}
+
+meter_mode_t get_mode()
+{
+    return meterMode.load();
+}
+
+uint32_t get_sample_rate()
 {
-    // Start DMA
-    dma_channel_start(dma_chan[buf_idx]);
+    return sampleRate;
+}
 
-    adc_select_input(PIN_ADC_OFFSET);  // start round-robin
-    adc_run(true);
+void start()
+{
+    adc_capture::start();
 }
 
 bool get_level(int level[NUM_ADC_CH], int peak_hold[NUM_ADC_CH])
 {
-    if (queue_get_level(&_level_queue) == 0) { return false; }
+    int id;
+    uint32_t num_dropped;
+    return get_level(level, peak_hold, id, num_dropped);
+}
 
+bool get_level(int level[NUM_ADC_CH], int peak_hold[NUM_ADC_CH], int& id, uint32_t& num_dropped)
+{
     // Get Level
     level_item_t levelItem;
-    queue_remove_blocking(&_level_queue, &levelItem);
+    if (!get_level_item(levelItem, num_dropped)) { return false; }
+    id = levelItem.id;
     for (int i = 0; i < NUM_ADC_CH; i++) {
         level[i] = levelItem.level[i];
     }
 
     if (peak_hold == nullptr) { return true; }
 
-    // Peak Hold
     for (int i = 0; i < NUM_ADC_CH; i++) {
-        if (peak_hold_level[i] < level[i]) {
-            peak_hold_level[i] = level[i];
-            peak_hold_count[i] = PEAK_HOLD_TIMES;
-        } else if (peak_hold_count[i] > 0) {
-            peak_hold_count[i]--;
+        peak_hold[i] = levelItem.peakHold[i];
+    }
+
+    return true;
+}
+
+bool get_level_item(level_item_t& item, uint32_t& num_dropped)
+{
+    if (!_level_queue.pop(item)) { return false; }
+    num_dropped = _level_queue.dropped();
+    return true;
+}
+
+void set_queue_policy(const overflow_policy_t policy)
+{
+    _level_queue.set_policy(policy);
+}
+
+void set_notify(notify_handler_t handler)
+{
+    notifyHandler.store(handler);
+}
+
+static inline void _notify()
+{
+    const notify_handler_t handler = notifyHandler.load(std::memory_order_relaxed);
+    if (handler != nullptr) { handler(); }
+}
+
+uint32_t get_num_lost_blocks()
+{
+    return adc_capture::get_num_lost();
+}
+
+bool get_latency(latency_t& latency)
+{
+    const uint32_t count = latencyCount.exchange(0);
+    if (count == 0) { return false; }
+    const uint32_t sum = latencySum.exchange(0);
+    latency.saturated = latencySaturated.exchange(false);
+    const uint32_t min = latencyMin.exchange(UINT32_MAX);
+    const uint32_t max = latencyMax.exchange(0);
+    const uint64_t rate = adc_capture::get_sample_rate();  // captured samples of all channels per second
+    latency.block_us = static_cast<uint32_t>(static_cast<uint64_t>(blockFrames) * 1000000 / sampleRate);
+    latency.min_us = static_cast<uint32_t>(static_cast<uint64_t>(min) * 1000000 / rate);
+    latency.ave_us = static_cast<uint32_t>(static_cast<uint64_t>(sum) * 1000000 / (rate * count));
+    latency.max_us = static_cast<uint32_t>(static_cast<uint64_t>(max) * 1000000 / rate);
+    latency.num_blocks = count;
+    return true;
+}
+
+// flash access in the safe zone (interrupts disabled on this core, the other core locked out)
+//   capture DMA keeps running without CPU, and the blocks held in the ring are processed
+//   by DMA IRQ at the exit of the safe zone
+static constexpr uint32_t FLASH_SAFE_TIMEOUT_MS = 100;  // to lock out the other core
+static bool (*flashFunc)() = nullptr;
+static bool flashResult;
+static uint32_t flashNumLost;
+
+static void _flash_access(void*)
+{
+    flashResult = flashFunc();
+    // blocks to be overwritten before DMA IRQ handles them
+    const uint32_t n = adc_capture::get_num_unhandled();
+    flashNumLost = (n > NUM_ADC_BUF - 1) ? n - (NUM_ADC_BUF - 1) : 0;
+}
+
+bool run_flash_access(bool (*func)(), uint32_t& num_lost)
+{
+    flashFunc = func;
+    flashResult = false;
+    flashNumLost = 0;
+    const int err = flash_safe_execute(_flash_access, nullptr, FLASH_SAFE_TIMEOUT_MS);
+    num_lost = flashNumLost;
+    return err == PICO_OK && flashResult;
+}
+
+void set_trace(const bool enable)
+{
+    traceEnable.store(enable);
+}
+
+int get_trace_frame(uint8_t buf[], const int size)
+{
+    static trace_item_t item;  // too large for stack with oversampling
+    if (size < TRACE_FRAME_SIZE || !_trace_queue.pop(item)) { return 0; }
+    int len = 0;
+    if (item.block.flags & trace::FLAG_START) {
+        const int n = trace::encode_header(traceHeader, &buf[wire_frame::HEADER_LEN]);
+        len += wire_frame::seal(buf, trace::FRAME_HEADER, n);
+    }
+    const int n = trace::encode_block(item.block, NUM_ADC_CH, item.raw, blockRawLen, &buf[len + wire_frame::HEADER_LEN]);
+    len += wire_frame::seal(&buf[len], trace::FRAME_BLOCK, n);
+    return len;
+}
+
+uint32_t get_num_trace_dropped()
+{
+    return _trace_queue.dropped();
+}
+
+void set_telemetry(const bool enable, const int batch)
+{
+    telemetryBatch = std::max(1, std::min(batch, telemetry::MAX_ITEMS));
+    if (enable && !telemetryEnable.load()) {
+        // discard the items left from the last streaming
+        level_item_t item;
+        while (_telemetry_queue.pop(item)) {}
+        telemetryPending = false;
+    }
+    telemetryEnable.store(enable);
+}
+
+int get_telemetry_frame(uint8_t buf[], const int size)
+{
+    // the frame needs the room of an item at least, and waits for the batch of items
+    if (size < wire_frame::OVERHEAD + 6 + telemetry::item_size(NUM_ADC_CH)) { return 0; }
+    if (!telemetryPending && _telemetry_queue.size() < static_cast<uint32_t>(telemetryBatch)) { return 0; }
+    telemetry::encoder enc(&buf[wire_frame::HEADER_LEN], std::min(size, TELEMETRY_FRAME_SIZE) - wire_frame::OVERHEAD, NUM_ADC_CH, _telemetry_queue.dropped());
+    while (enc.num_items() < telemetryBatch) {
+        if (!telemetryPending && !_telemetry_queue.pop(telemetryItem)) { break; }
+        telemetryPending = true;
+        telemetry::item_t t;
+        t.id = static_cast<uint32_t>(telemetryItem.id);
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            t.code[i] = telemetryItem.rawValue[i];
+            t.level[i] = static_cast<uint8_t>(telemetryItem.level[i]);
+            t.peak_hold[i] = static_cast<uint8_t>(telemetryItem.peakHold[i]);
+        }
+        if (!enc.add(t)) { break; }  // sent in the next frame
+        telemetryPending = false;
+    }
+    return wire_frame::seal(buf, telemetry::FRAME_LEVEL, enc.len());
+}
+
+uint32_t get_num_telemetry_dropped()
+{
+    return _telemetry_queue.dropped();
+}
+
+void set_pcm_stream(const bool enable)
+{
+    if (enable && !pcmEnable && pcmState == pcm_state_t::IDLE) {
+        pcmSeq = adc_capture::get_write_seq();
+    }
+    pcmEnable = enable;
+}
+
+int get_pcm_data(const uint8_t*& data, const int max_len)
+{
+    const int SAMPLES_LEN = blockRawLen * sizeof(uint16_t);
+    if (max_len <= 0) { return 0; }
+    if (pcmState == pcm_state_t::IDLE) {
+        if (!pcmEnable) { return 0; }
+        const uint32_t wr = adc_capture::get_write_seq();
+        if (wr == pcmSeq) { return 0; }  // not completed yet
+        if (wr - pcmSeq > NUM_ADC_BUF - 1) {
+            // skip the blocks overwritten before being sent
+            const uint32_t next = wr - (NUM_ADC_BUF - 1);
+            pcmNumOverruns += next - pcmSeq;
+            pcmSeq = next;
+        }
+        const pcm::prefix_t p = {pcmSeq, pcmNumOverruns, adc_capture::get_sample_rate(), NUM_ADC_CH, ADC_BITS};
+        pcm::encode_prefix(p, &pcmHeader[wire_frame::HEADER_LEN]);
+        wire_frame::begin(pcmHeader, pcm::FRAME_PCM, pcm::PREFIX_LEN + SAMPLES_LEN);
+        pcmCrc = wire_frame::crc16(&pcmHeader[2], 3 + pcm::PREFIX_LEN);
+        pcmCrc = wire_frame::crc16(reinterpret_cast<const uint8_t*>(_dma_block(pcmSeq)), SAMPLES_LEN, pcmCrc);
+        pcmState = pcm_state_t::HEADER;
+        pcmPos = 0;
+    }
+    int size;
+    if (pcmState == pcm_state_t::HEADER) {
+        data = &pcmHeader[pcmPos];
+        size = sizeof(pcmHeader);
+    } else if (pcmState == pcm_state_t::SAMPLES) {
+        data = &reinterpret_cast<const uint8_t*>(_dma_block(pcmSeq))[pcmPos];
+        size = SAMPLES_LEN;
+    } else {
+        if (pcmPos == 0) {
+            // all the samples have been handed to serial: valid unless DMA has come back to the block
+            if (adc_capture::get_write_seq() - pcmSeq > NUM_ADC_BUF - 1) {
+                pcmCrc = ~pcmCrc;
+                pcmNumOverruns++;
+            }
+            pcmTrailer[0] = static_cast<uint8_t>(pcmCrc & 0xff);
+            pcmTrailer[1] = static_cast<uint8_t>(pcmCrc >> 8);
+        }
+        data = &pcmTrailer[pcmPos];
+        size = sizeof(pcmTrailer);
+    }
+    const int len = std::min(max_len, size - pcmPos);
+    pcmPos += len;
+    if (pcmPos == size) {
+        pcmPos = 0;
+        if (pcmState == pcm_state_t::HEADER) {
+            pcmState = pcm_state_t::SAMPLES;
+        } else if (pcmState == pcm_state_t::SAMPLES) {
+            pcmState = pcm_state_t::TRAILER;
+        } else {
+            pcmState = pcm_state_t::IDLE;
+            pcmSeq++;
+        }
+    }
+    return len;
+}
+
+bool is_pcm_in_frame()
+{
+    return pcmState != pcm_state_t::IDLE;
+}
+
+uint32_t get_num_pcm_overruns()
+{
+    return pcmNumOverruns;
+}
+
+static void _replay_range_handler(const int)
+{
+    // the switching is given by the trace
+}
+
+bool replay_trace(const uint8_t type, const uint8_t payload[], const int len)
+{
+    if (type == trace::FRAME_HEADER) {
+        trace::header_t h;
+        if (!trace::decode_header(payload, len, h)) { return false; }
+        if (h.num_ch != NUM_ADC_CH || h.block_frames != blockFrames || h.oversample != ADC_OVERSAMPLE ||
+            h.num_modes != static_cast<int>(meter_mode_t::NUM_MODES) || h.num_ranges != NUM_RANGES) { return false; }
+        // the state at the start block of trace
+        set_sample_rate(h.sample_rate);
+        for (int i = 0; i < h.num_modes; i++) {
+            engine.set_coef(static_cast<meter_mode_t>(i), h.k_att[i], h.k_rel[i]);
+        }
+        for (int r = 0; r < NUM_RANGES; r++) {
+            rangeGain[r] = h.range_gain[r];
+        }
+        rangeNumLevels = h.range_num_levels;
+        for (int k = 0; k < rangeNumLevels; k++) {
+            rangeThreshold[k] = h.range_threshold[k];
+        }
+        rangeHandler = _replay_range_handler;
+        if (h.calibrating) {
+            _force_zero();
+            calibCount = h.calib_count;
+            state = State::CALIBRATION;
         } else {
-            peak_hold_level[i] = -1;
+            for (int i = 0; i < NUM_ADC_CH; i++) {
+                _apply_zero(i, h.zero[i]);
+                calibZeroRef[i] = h.zero_ref[i];
+            }
+            state = State::RUNNING;
         }
-        peak_hold[i] = peak_hold_level[i];
+        _reset_processing();
+        return true;
+    } else if (type == trace::FRAME_BLOCK) {
+        static uint16_t raw[ADC_RAW_LEN];
+        trace::block_t b;
+        int rawLen;
+        if (!trace::decode_block(payload, len, NUM_ADC_CH, b, raw, ADC_RAW_LEN, rawLen) || rawLen != blockRawLen) { return false; }
+        if (b.mode >= static_cast<int>(meter_mode_t::NUM_MODES)) { return false; }
+        // the events recorded with the block
+        meterMode.store(static_cast<meter_mode_t>(b.mode));
+        calibReq.store((b.flags & trace::FLAG_CALIB) != 0);
+        rangeEnable.store((b.flags & trace::FLAG_AUTO_RANGE) != 0);
+        rangeSwitchPos.store(b.switch_pos);
+        rangeSwitched.store((b.flags & trace::FLAG_SWITCH) != 0);
+        process_block(raw, b.seq);
+        return true;
     }
+    return false;
+}
 
+void set_true_peak(const bool enable)
+{
+    truePeakEnable.store(enable);
+}
+
+bool get_true_peak(float dbtp[NUM_ADC_CH], uint32_t num_over[NUM_ADC_CH])
+{
+    if (!truePeakEnable.load()) { return false; }
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        const int32_t peak = truePeakMax[i].exchange(0);
+        dbtp[i] = (peak > 0) ? 20.0f * log10f(static_cast<float>(peak) / FULL_SCALE_CODE) : -99.9f;
+        num_over[i] = truePeakOvers[i].load();
+    }
     return true;
 }
 
+void clear_overs()
+{
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        truePeakOvers[i].store(0);
+    }
+}
+
+void set_loudness(const bool enable)
+{
+    if (enable && !loudnessEnable.load()) {
+        loudnessResetReq.store(true);
+    }
+    loudnessEnable.store(enable);
+}
+
+bool get_loudness(lufs_t& lufs)
+{
+    if (!loudnessEnable.load()) { return false; }
+    loudnessMeter.get(lufs);
+    return true;
+}
+
+void reset_loudness()
+{
+    loudnessResetReq.store(true);
+}
+
+void set_stereo(const bool enable)
+{
+    if (NUM_ADC_CH < 2) { return; }
+    if (enable && !stereoEnable.load()) {
+        stereoResetReq.store(true);
+    }
+    stereoEnable.store(enable);
+}
+
+bool get_stereo(stereo_t& st)
+{
+    if (!stereoEnable.load()) { return false; }
+    stereoMeter.get(st);
+    return true;
+}
+
+void set_spectrum(const bool enable)
+{
+    spectrumEnable.store(enable);
+}
+
+void set_spectrum_rate(const uint32_t fps)
+{
+    spectrumRate = (fps == 0) ? 1 : fps;
+    _update_rate_dependents();
+}
+
+bool get_spectrum(int level[NUM_BANDS])
+{
+    spectrum_item_t spectrumItem;
+    if (!_spectrum_queue.pop(spectrumItem)) { return false; }
+    for (int i = 0; i < NUM_BANDS; i++) {
+        level[i] = spectrumItem.level[i];
+    }
+    return true;
+}
+
+uint32_t get_num_skipped_frames()
+{
+    return spectrumMeter.get_num_skipped();
+}
+
+void set_auto_range_scale(const float db_scale[], const int num_levels)
+{
+    for (int r = 0; r < NUM_RANGES; r++) {
+        rangeGain[r] = static_cast<int32_t>(lroundf(256.0f * powf(10.0f, static_cast<float>(RANGE_STEP_DB * r) / 20.0f)));
+    }
+    // the top of dB scale is the full scale at the maximum attenuation
+    rangeNumLevels = std::min(num_levels, MAX_RANGE_LEVELS);
+    const float top = static_cast<float>(FULL_SCALE_CODE) * rangeGain[NUM_RANGES - 1];
+    for (int k = 0; k < rangeNumLevels; k++) {
+        rangeThreshold[k] = static_cast<uint32_t>(ceilf(top * powf(10.0f, (db_scale[k] - db_scale[num_levels - 1]) / 20.0f)));
+    }
+}
+
+void set_auto_range(const bool enable, range_handler_t handler)
+{
+    if (enable) { rangeHandler = handler; }
+    rangeEnable.store(enable && rangeHandler != nullptr);
+}
+
+bool get_auto_range(int& att_db)
+{
+    if (!rangeEnable.load()) { return false; }
+    att_db = rangeAttDb.load();
+    return true;
+}
+
+void notify_range_switched()
+{
+    rangeSwitchPos.store(adc_capture::get_position(), std::memory_order_relaxed);
+    rangeSwitched.store(true, std::memory_order_release);
+}
+
+void set_calib_zero(const int32_t zero[NUM_ADC_CH])
+{
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        if (zero[i] < 0) { return; }
+    }
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        _apply_zero(i, zero[i]);
+        calibZeroRef[i] = zero[i];
+    }
+    calibPreset = true;
+}
+
+bool get_calib_zero(int32_t zero[NUM_ADC_CH])
+{
+    if (calibReq.load()) { return false; }
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        zero[i] = calibZero[i].load();
+        if (zero[i] < 0) { return false; }
+    }
+    return true;
+}
+
+void recalibrate()
+{
+    calibReq.store(true);
+}
+
 void stop()
 {
-    // Once DMA finishes, stop any new conversions from starting, and clean up
-    // the FIFO in case the ADC was still mid-conversion.
-    adc_run(false);
-    adc_fifo_drain();
+    adc_capture::stop();
+}
+
+// true-peak detection
+static inline void _true_peak(const uint16_t* block, const int32_t gain[NUM_ADC_CH], const int32_t ofs[NUM_ADC_CH])
+{
+    PERF_SCOPE(TRUE_PEAK);
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        uint32_t num_over;
+        const int32_t peak = truePeakCh[i].process(&block[i], NUM_ADC_CH, blockFrames, gain[i], ofs[i], FULL_SCALE_CODE, num_over);
+        int32_t cur = truePeakMax[i].load(std::memory_order_relaxed);
+        while (peak > cur && !truePeakMax[i].compare_exchange_weak(cur, peak, std::memory_order_relaxed)) {}
+        if (num_over > 0) { truePeakOvers[i].fetch_add(num_over, std::memory_order_relaxed); }
+    }
+}
+
+// loudness measurement
+static inline void _loudness(const uint16_t* block, const int32_t gain[NUM_ADC_CH], const int32_t ofs[NUM_ADC_CH])
+{
+    PERF_SCOPE(LOUDNESS);
+    if (loudnessResetReq.exchange(false, std::memory_order_relaxed)) {
+        loudnessMeter.reset();
+    }
+    loudnessMeter.process(block, blockFrames, gain, ofs);
+}
+
+// stereo analysis
+static inline void _stereo(const uint16_t* block, const int32_t gain[NUM_ADC_CH], const int32_t ofs[NUM_ADC_CH])
+{
+    if constexpr (NUM_ADC_CH >= 2) {
+        PERF_SCOPE(STEREO);
+        if (stereoResetReq.exchange(false, std::memory_order_relaxed)) {
+            stereoMeter.reset();
+        }
+        stereoMeter.process(block, blockFrames, gain, ofs);
+    }
+}
+
+// spectrum analyser (FFT of the captured frame in the lowest priority, preempted by DMA IRQ)
+static void __isr spectrum_irq_handler()
+{
+    PERF_SCOPE(SPECTRUM);
+    int32_t amp[NUM_BANDS];
+    spectrumMeter.compute(amp);
+    unsigned int level[NUM_BANDS];
+    engine.code_to_level<NUM_BANDS>(amp, 0, level, dBLevelBand);
+    spectrum_item_t spectrumItem;
+    for (int i = 0; i < NUM_BANDS; i++) {
+        spectrumItem.level[i] = level[i];
+    }
+    _spectrum_queue.push(spectrumItem);
+    _notify();
+}
+
+static void _spectrum_irq_init()
+{
+    // user IRQ is per core, which is the same core as DMA IRQ
+    spectrumIrq = user_irq_claim_unused(true);
+    irq_set_exclusive_handler(spectrumIrq, spectrum_irq_handler);
+    irq_set_priority(spectrumIrq, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(spectrumIrq, true);
 }
 
-// irq handler for DMA
-static void __isr __time_critical_func(level_meter_dma_irq_handler)()
+// auto-ranging: calibration of true-peak, loudness and spectrum for current range
+static void _range_calib()
 {
-    int irq_buf_idx;
+    const int32_t* gain = engine.get_gain();
+    const int32_t* ofs = engine.get_ofs();
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        rangeCalibGain[i] = static_cast<int32_t>(static_cast<int64_t>(gain[i]) * rangeGain[rangeCur] / rangeGain[NUM_RANGES - 1]);
+        rangeCalibOfs[i] = ofs[i] * rangeGain[rangeCur] / rangeGain[NUM_RANGES - 1];
+    }
+    rangeAttDb.store(-RANGE_STEP_DB * rangeCur, std::memory_order_relaxed);
+}
+
+static void _range_request(const int range, const uint32_t seq)
+{
+    rangeReq = range;
+    rangeReqSeq = seq;
+    rangeLowBlocks = 0;
+    rangeSwitched.store(false, std::memory_order_relaxed);
+    rangeHandler(-RANGE_STEP_DB * range);
+}
+
+// auto-ranging: start and stop (returns true if active)
+static inline bool _range_active(const uint32_t seq)
+{
+    const bool req = rangeEnable.load(std::memory_order_relaxed);
+    if (req) { traceFlags |= trace::FLAG_AUTO_RANGE; }
+    const bool enable = state == State::RUNNING && req;
+    if (enable && !rangeActive) {
+        // start from the maximum attenuation, the level is held until it surely takes effect
+        rangeActive = true;
+        rangeCur = NUM_RANGES - 1;
+        _range_calib();
+        _range_request(rangeCur, seq);
+        rangeSkipFrames = (rangeTimeoutBlocks + 1) * blockFrames;
+        engine.reset_ballistics(meterMode.load(std::memory_order_relaxed));
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            rangeCode[i] = 0;
+        }
+    } else if (!enable) {
+        rangeActive = false;
+    }
+    return rangeActive;
+}
+
+// auto-ranging: the frame at which the requested range takes effect in the block (blockFrames if not in the block)
+static inline int _range_switch_frame(const uint32_t seq)
+{
+    if (rangeReq == rangeCur) { return blockFrames; }
+    if (rangeSwitched.load(std::memory_order_acquire)) {
+        const uint32_t pos = rangeSwitchPos.load(std::memory_order_relaxed);
+        traceFlags |= trace::FLAG_SWITCH;
+        traceSwitchPos = pos;
+        const int32_t d = static_cast<int32_t>(pos - seq * blockRawLen) / (NUM_ADC_CH * ADC_OVERSAMPLE);
+        if (d < blockFrames) { return (d < 0) ? 0 : d; }  // switched before the block: from the top
+    } else if (seq - rangeReqSeq >= rangeTimeoutBlocks) {
+        return 0;
+    }
+    return blockFrames;
+}
+
+// auto-ranging: compensated code (Q8) of the block
+static inline void _range_code(const uint16_t* block, const uint32_t seq, const meter_mode_t mode, int32_t code[NUM_ADC_CH])
+{
+    // frames [0, skip) settling, [skip, sw) current range, [sw, sw + settle) settling and the rest new range
+    const int skip = std::min<uint32_t>(rangeSkipFrames, blockFrames);
+    rangeSkipFrames -= skip;
+    const int sw = std::max(_range_switch_frame(seq), skip);
+    int resume = blockFrames;
+    if (sw < blockFrames) {
+        rangeSkipFrames = rangeSettleFrames;
+        resume = sw + std::min<uint32_t>(rangeSkipFrames, blockFrames - sw);
+        rangeSkipFrames -= resume - sw;
+    }
+    const int32_t* gain = engine.get_gain();
+    const int32_t* ofs = engine.get_ofs();
+    if (mode == meter_mode_t::TRIMMED_MEAN) {
+        // only a whole block of a range
+        if (skip == 0 && sw == blockFrames) {
+            uint32_t sum[NUM_ADC_CH];
+            trimmed_mean_t::get_sum(block, blockFrames, sum);
+            for (int i = 0; i < NUM_ADC_CH; i++) {
+                const int32_t c = engine.get_trimmed_mean_code(i, sum[i]);
+                rangeCode[i] = std::max<int32_t>(c, 0) * rangeGain[rangeCur];
+            }
+        }
+    } else {
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            engine.get_ballistics(i).process(&block[skip * NUM_ADC_CH + i], NUM_ADC_CH, sw - skip, gain[i], ofs[i]);
+        }
+    }
+    if (sw < blockFrames) {
+        // the state follows the gain of new range at the switching frame
+        const int32_t ratio = static_cast<int32_t>((static_cast<int64_t>(rangeGain[rangeCur]) << 16) / rangeGain[rangeReq]);
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            engine.get_ballistics(i).scale(ratio);
+            if (resume < blockFrames) {
+                engine.get_ballistics(i).process(&block[resume * NUM_ADC_CH + i], NUM_ADC_CH, blockFrames - resume, gain[i], ofs[i]);
+            }
+        }
+        rangeCur = rangeReq;
+        rangeSwitched.store(false, std::memory_order_relaxed);
+        _range_calib();
+    }
+    if (mode != meter_mode_t::TRIMMED_MEAN) {
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            rangeCode[i] = engine.get_ballistics(i).get_value() * rangeGain[rangeCur];
+        }
+    }
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        code[i] = rangeCode[i];
+    }
+}
 
-    for (irq_buf_idx = 0; irq_buf_idx < 2; irq_buf_idx++) {
-        if (dma_irqn_get_channel_status(PICO_LEVEL_METER_DMA_IRQ, dma_chan[irq_buf_idx])) {
-            dma_irqn_acknowledge_channel(PICO_LEVEL_METER_DMA_IRQ, dma_chan[irq_buf_idx]);
-            break;
+// auto-ranging: dB level conversion of compensated code (Q8)
+static inline void _range_level(const int32_t code[NUM_ADC_CH], unsigned int level[NUM_ADC_CH])
+{
+    PERF_SCOPE(CONV_DB_LEVEL);
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        level[i] = threshold_level(code[i], rangeThreshold, rangeNumLevels);
+    }
+}
+
+// auto-ranging: select the range by the peak of the block (one request at a time)
+static inline void _range_update(const uint16_t* block, const uint32_t seq)
+{
+    if (rangeReq != rangeCur || rangeSkipFrames > 0) { return; }
+    const int32_t* gain = engine.get_gain();
+    const int32_t* ofs = engine.get_ofs();
+    int32_t peak = 0;
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        uint16_t raw = 0;
+        for (int j = 0; j < blockFrames; j++) {
+            raw = std::max(raw, block[j * NUM_ADC_CH + i]);
+        }
+        peak = std::max(peak, dsp::calib(raw, gain[i], ofs[i]));
+    }
+    if (peak >= RANGE_HIGH_CODE && rangeCur < NUM_RANGES - 1) {
+        _range_request(rangeCur + 1, seq);
+    } else if (peak < RANGE_LOW_CODE && rangeCur > 0) {
+        if (++rangeLowBlocks >= rangeHoldBlocks) {
+            _range_request(rangeCur - 1, seq);
         }
+    } else {
+        rangeLowBlocks = 0;
     }
-    if (irq_buf_idx >= 2) { return; }
+}
 
-    float norm[NUM_ADC_CH];
+// background tracking of zero level during silence
+static inline void _track_zero(const uint16_t* block)
+{
+    bool updated = false;
     for (int i = 0; i < NUM_ADC_CH; i++) {
-        // insert keeping sorted
-        std::vector<uint16_t> buf;
-        for (int j = 0; j < ADC_BUF_LEN; j += NUM_ADC_CH) {
-            uint16_t val = dma_buf[irq_buf_idx][j + i];
-            auto it = std::upper_bound(buf.cbegin(), buf.cend(), val);
-            buf.insert(it, val);
+        uint32_t sum = 0;
+        uint16_t min = 0xffff;
+        uint16_t max = 0;
+        for (int j = 0; j < blockFrames; j++) {
+            const uint16_t v = block[j * NUM_ADC_CH + i];
+            sum += v;
+            min = std::min(min, v);
+            max = std::max(max, v);
         }
-        // pick center samples and average
-        const int start = ADC_BUF_LEN / 2 / 4;
-        const int end   = ADC_BUF_LEN / 2 * 3 / 4;
-        uint16_t sum = 0;
-        for (int j = start; j < end; j++) {
-            sum += buf[j];
+        if (dsp::calib(max, engine.get_gain()[i], engine.get_ofs()[i]) > 0 || max - min > ZERO_TRACK_SPREAD) { continue; }
+        const int32_t mean = static_cast<int32_t>((sum << ZERO_FRAC) / blockFrames);
+        if (std::abs(mean - calibZeroRef[i]) > (ZERO_TRACK_LIMIT << ZERO_FRAC)) { continue; }
+        const int32_t zero = calibZero[i].load(std::memory_order_relaxed);
+        const int32_t next = zero + ((mean - zero) >> ZERO_TRACK_SHIFT);
+        if (next != zero) {
+            _apply_zero(i, next);
+            updated = true;
+        }
+    }
+    if (updated && rangeActive) {
+        _range_calib();
+    }
+}
+
+// reset the state of block processing which depends on the past blocks (except zero level)
+static void _reset_processing()
+{
+    engine.reset(meterMode.load(std::memory_order_relaxed));
+    rangeActive = false;  // auto-ranging restarts from the maximum attenuation
+}
+
+// trace: reset the processing and keep the state at the start block
+static void _trace_start(const uint32_t seq)
+{
+    _reset_processing();
+    trace::header_t& h = traceHeader;
+    h.version = trace::VERSION;
+    h.seq = seq;
+    h.sample_rate = sampleRate;
+    h.num_ch = NUM_ADC_CH;
+    h.block_frames = blockFrames;
+    h.oversample = ADC_OVERSAMPLE;
+    h.calibrating = (state == State::CALIBRATION) ? 1 : 0;
+    h.calib_count = static_cast<uint16_t>(calibCount);
+    h.num_modes = static_cast<uint8_t>(meter_mode_t::NUM_MODES);
+    h.num_ranges = NUM_RANGES;
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        h.zero[i] = calibZero[i].load(std::memory_order_relaxed);
+        h.zero_ref[i] = calibZeroRef[i];
+    }
+    for (int i = 0; i < h.num_modes; i++) {
+        const ballistics::coef_t& coef = engine.get_coef(static_cast<meter_mode_t>(i));
+        h.k_att[i] = coef.k_att;
+        h.k_rel[i] = coef.k_rel;
+    }
+    for (int r = 0; r < NUM_RANGES; r++) {
+        h.range_gain[r] = rangeGain[r];
+    }
+    const uint32_t* threshold = engine.get_level_threshold();
+    h.num_levels = (engine.get_level_table() != nullptr && threshold != nullptr) ? static_cast<uint8_t>(std::min(engine.get_num_levels(), trace::MAX_LEVELS)) : 0;
+    for (int k = 0; k < h.num_levels; k++) {
+        h.threshold[k] = threshold[k];
+    }
+    h.range_num_levels = static_cast<uint8_t>(rangeNumLevels);
+    for (int k = 0; k < rangeNumLevels; k++) {
+        h.range_threshold[k] = rangeThreshold[k];
+    }
+    traceGap = false;
+    traceFlags |= trace::FLAG_START;
+}
+
+// trace: queue the raw block with its events and the level item (written in place)
+static inline void _trace_push(const uint16_t* raw_block, const meter_mode_t mode, const level_item_t& item)
+{
+    trace_item_t* t = _trace_queue.claim();
+    if (t == nullptr) {
+        traceGap = true;
+        return;
+    }
+    trace::block_t& b = t->block;
+    b.seq = static_cast<uint32_t>(item.id);
+    b.flags = traceFlags | (traceGap ? trace::FLAG_GAP : 0);
+    b.mode = static_cast<uint8_t>(mode);
+    b.switch_pos = traceSwitchPos;
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        b.code[i] = item.rawValue[i];
+        b.level[i] = static_cast<uint8_t>(item.level[i]);
+        b.peak_hold[i] = static_cast<uint8_t>(item.peakHold[i]);
+    }
+    memcpy(t->raw, raw_block, blockRawLen * sizeof(uint16_t));
+    _trace_queue.commit();
+    traceGap = false;
+}
+
+// block processing (called from DMA IRQ)
+static void __time_critical_func(process_block)(const uint16_t* raw_block, const uint32_t seq)
+{
+    PERF_SCOPE(PROCESS_BLOCK);
+    // trace from this block
+    traceFlags = 0;
+    const bool trace = traceEnable.load(std::memory_order_relaxed);
+    if (trace && !traceActive) {
+        _trace_start(seq);
+    }
+    traceActive = trace;
+
+    // zero calibration request
+    if (calibReq.load(std::memory_order_relaxed)) {
+        traceFlags |= trace::FLAG_CALIB;
+        _force_zero();
+        state = State::CALIBRATION;
+        calibReq.store(false);  // after the zero level is invalidated
+    }
+
+    // apply mode change
+    const meter_mode_t mode = meterMode.load(std::memory_order_relaxed);
+    engine.set_mode(mode);
+
+    int32_t code[NUM_ADC_CH];
+    unsigned int level[NUM_ADC_CH];
+    const uint16_t* block;
+    const bool autoRange = _range_active(seq);
+    if (autoRange) {
+        // compensated code (Q8) by the attenuation of auto-ranging (dB level and peak hold follow below)
+        block = engine.front_end(raw_block);
+        _range_code(block, seq, mode, code);
+    } else {
+        // all the stages of the engine: decimation, trimmed mean (always during zero calibration)
+        // or per-sample ballistics, dB level conversion and peak hold
+        block = engine.process(raw_block, seq, mode, code, level, state == State::CALIBRATION);
+    }
+
+    const int32_t* gain = autoRange ? rangeCalibGain : engine.get_gain();
+    const int32_t* ofs = autoRange ? rangeCalibOfs : engine.get_ofs();
+    if (state == State::RUNNING && truePeakEnable.load(std::memory_order_relaxed)) {
+        _true_peak(block, gain, ofs);
+    }
+    if (state == State::RUNNING && loudnessEnable.load(std::memory_order_relaxed)) {
+        _loudness(block, gain, ofs);
+    }
+    if (state == State::RUNNING && stereoEnable.load(std::memory_order_relaxed)) {
+        _stereo(block, gain, ofs);
+    }
+    if (state == State::RUNNING && spectrumEnable.load(std::memory_order_relaxed)) {
+        if (spectrumMeter.push(block, blockFrames, gain, ofs)) {
+            irq_set_pending(spectrumIrq);
         }
-        // normalize
-        float meanAve = (float) sum / (end - start);
-        norm[i] = meanAve / ADC_MAX;
-        // apply calibration
-        norm[i] = ADC_CALIB_A[i] * norm[i] + ADC_CALIB_B[i];
-        norm[i] /= RANGE_RATIO;
-        if (norm[i] < 0.0) { norm[i] = 0.0; }
-        if (norm[i] > 1.0) { norm[i] = 1.0; }
     }
 
     // Zero Calibration
     if (state == State::CALIBRATION) {
-        if (calibCount >= NUM_CALIB_COUNT) {
+        if (calibCount >= calibSettleBlocks + NUM_CALIB_COUNT) {
             for (int i = 0; i < NUM_ADC_CH; i++) {
                 // calculate calibration parameters
-                float intercept = -norm[i] * ADC_CALIB_ZERO_MARGIN;
-                ADC_CALIB_A[i] = 1.0 / (1.0 + intercept);
-                ADC_CALIB_B[i] = intercept;
+                const int32_t zero = std::max<int32_t>(code[i], 0) << (ZERO_FRAC - CODE_FRAC);
+                _apply_zero(i, zero);
+                calibZeroRef[i] = zero;
                 // release force input signal
                 uint pin = PIN_ADC_BASE + PIN_ADC_OFFSET + i;
                 gpio_set_dir(pin, GPIO_IN);
             }
             state = State::RUNNING;
+            if (rangeActive) { _range_calib(); }
         } else {
             calibCount++;
         }
+    } else if (state == State::RUNNING) {
+        _track_zero(block);
+    }
+
+    // auto-ranging: dB level conversion and peak hold (time based)
+    if (autoRange) {
+        _range_level(code, level);
+        _range_update(block, seq);
+        engine.hold(level, seq);
     }
 
-    unsigned int level[NUM_ADC_CH];
-    dBLevel->get_level(norm, level);
     level_item_t levelItem;
-    levelItem.id = dma_irq_count;
+    levelItem.id = static_cast<int>(seq);
     for (int i = 0; i < NUM_ADC_CH; i++) {
+        levelItem.rawValue[i] = code[i];
         levelItem.level[i] = level[i];
+        levelItem.peakHold[i] = engine.get_peak_hold(i);
     }
-    if (!queue_try_add(&_level_queue, &levelItem)) {
-        printf("failed to add queue\n");
+    _level_queue.push(levelItem);  // overflow is counted in the queue (no printf in IRQ)
+    if (telemetryEnable.load(std::memory_order_relaxed)) {
+        _telemetry_queue.push(levelItem);
     }
 
-    dma_channel_configure(dma_chan[irq_buf_idx], &cfg[irq_buf_idx],
-        dma_buf[irq_buf_idx],  // dst
-        &adc_hw->fifo,         // src
-        ADC_BUF_LEN,           // transfer count
-        false                  // start immediately
-    );
+    if (traceActive) {
+        _trace_push(raw_block, mode, levelItem);
+    }
+    _notify();  // after all the items of the block are queued
+}
 
-    dma_irq_count++;
+// captured block handler (called from DMA IRQ): block processing and its latency
+static void __time_critical_func(capture_block)(const uint16_t* raw_block, const uint32_t seq)
+{
+    process_block(raw_block, seq);
+    // the level item is available to get_level() now
+    const uint32_t elapsed = adc_capture::get_position() - seq * blockRawLen;
+    if (elapsed < latencyMin.load(std::memory_order_relaxed)) { latencyMin.store(elapsed, std::memory_order_relaxed); }
+    if (elapsed > latencyMax.load(std::memory_order_relaxed)) { latencyMax.store(elapsed, std::memory_order_relaxed); }
+    uint32_t sum = latencySum.load(std::memory_order_relaxed);
+    do {
+        if (elapsed > UINT32_MAX - sum) {
+            latencySaturated.store(true, std::memory_order_relaxed);
+            return;
+        }
+    } while (!latencySum.compare_exchange_weak(sum, sum + elapsed, std::memory_order_relaxed));
+    latencyCount.fetch_add(1, std::memory_order_release);
 }
 }
\ No newline at end of file
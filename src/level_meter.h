@@ -10,15 +10,200 @@
 #define PICO_LEVEL_METER_DMA_IRQ 0
 #endif
 
+// 1: DMA IRQ and signal processing run on core1 (core0 is left for UI)
+#ifndef PICO_LEVEL_METER_CORE1
+#define PICO_LEVEL_METER_CORE1 0
+#endif
+
+// the number of level items queued from IRQ to get_level() (power of 2)
+#ifndef PICO_LEVEL_METER_QUEUE_LENGTH
+#define PICO_LEVEL_METER_QUEUE_LENGTH 4
+#endif
+
+// the number of blocks in DMA capture ring (power of 2)
+//   the ring holds the blocks captured during flash access (15 blocks: 300 ms at 500 Hz)
+#ifndef PICO_LEVEL_METER_NUM_BLOCKS
+#define PICO_LEVEL_METER_NUM_BLOCKS 16
+#endif
+
+// oversampling ratio of ADC decimated by CIC front end (power of 2 up to 64, 1: no oversampling)
+#ifndef PICO_LEVEL_METER_OVERSAMPLE
+#define PICO_LEVEL_METER_OVERSAMPLE 1
+#endif
+
+// the number of ADC channels metered (1 ~ 4: ADC inputs from PICO_LEVEL_METER_ADC_OFFSET)
+#ifndef PICO_LEVEL_METER_NUM_CH
+#define PICO_LEVEL_METER_NUM_CH 2
+#endif
+
+// the first ADC input used (GPIO 26 + offset)
+#ifndef PICO_LEVEL_METER_ADC_OFFSET
+#define PICO_LEVEL_METER_ADC_OFFSET 0
+#endif
+
+// frames per block of each channel (after decimation) in standard profile
+#ifndef PICO_LEVEL_METER_BLOCK_FRAMES
+#define PICO_LEVEL_METER_BLOCK_FRAMES 10
+#endif
+
+// frames per block in low-latency profile (2 or more)
+#ifndef PICO_LEVEL_METER_LOW_LATENCY_FRAMES
+#define PICO_LEVEL_METER_LOW_LATENCY_FRAMES 4
+#endif
+
+// frames per block in high-accuracy profile (the DMA ring is sized by the largest profile)
+#ifndef PICO_LEVEL_METER_HIGH_ACCURACY_FRAMES
+#define PICO_LEVEL_METER_HIGH_ACCURACY_FRAMES 40
+#endif
+
+// the number of raw blocks queued from IRQ to get_trace_frame() while tracing (power of 2)
+#ifndef PICO_LEVEL_METER_TRACE_LENGTH
+#define PICO_LEVEL_METER_TRACE_LENGTH 16
+#endif
+
+// the number of level items queued from IRQ to get_telemetry_frame() while streaming telemetry (power of 2)
+#ifndef PICO_LEVEL_METER_TELEMETRY_LENGTH
+#define PICO_LEVEL_METER_TELEMETRY_LENGTH 64
+#endif
+
+#include <algorithm>
+
+#include "ballistics.h"
 #include "conv_dB_level.h"
+#include "loudness.h"
+#include "spectrum.h"
+#include "stereo.h"
+#include "pcm_format.h"
+#include "spsc_ring.h"
+#include "telemetry_format.h"
+#include "trace_format.h"
+#include "wire_frame.h"
+
+#define PIN_ADC_OFFSET PICO_LEVEL_METER_ADC_OFFSET  // use ADC channel from PIN_ADC_BASE + PIN_ADC_OFFSET
+#define NUM_ADC_CH PICO_LEVEL_METER_NUM_CH          // number of channels
 
-#define PIN_ADC_OFFSET 0  // use ADC channel from PIN_ADC_BASE + PIN_ADC_OFFSET
-#define NUM_ADC_CH 2      // number of channels
+static_assert(NUM_ADC_CH >= 1 && PIN_ADC_OFFSET >= 0 && PIN_ADC_OFFSET + NUM_ADC_CH <= 4, "ADC channels must be within ADC0 ~ ADC3");
 
 namespace level_meter
 {
+    static constexpr int ADC_BITS = 12;
+    // RANGE_RATIO: 900mV / 3300mV
+    //   This is determined by the OPAMP hardware circuit
+    //   under maximum FM62429 input level without distortion
+    static constexpr int RANGE_RATIO_NUM = 900;
+    static constexpr int RANGE_RATIO_DEN = 3300;
+    static constexpr uint32_t DEFAULT_SAMPLE_RATE = 500;  // sampling rate per channel (Hz)
+    static constexpr int NUM_BANDS = spectrum::NUM_BANDS;  // bands of spectrum analyser
+    static constexpr uint32_t DEFAULT_SPECTRUM_RATE = 25;  // frames per second of spectrum analyser
+    static constexpr int RANGE_STEP_DB = 12;     // attenuation step of auto-ranging
+    static constexpr int NUM_RANGES = 3;         // attenuation of auto-ranging: 0, -12 and -24 dB
+    static constexpr int MAX_RANGE_LEVELS = 64;  // the number of steps in dB scale of auto-ranging
+    static constexpr int BLOCK_FRAMES = PICO_LEVEL_METER_BLOCK_FRAMES;  // frames per block in standard profile (after decimation)
+    static constexpr int FRAME_RAW_LEN = NUM_ADC_CH * PICO_LEVEL_METER_OVERSAMPLE;  // captured samples per frame
+    static constexpr int MAX_FRAME_BLOCK_RAW_LEN = (wire_frame::MAX_PAYLOAD - pcm::PREFIX_LEN) / 2;  // captured samples of a block sent in a frame of PCM stream
+    static_assert(BLOCK_FRAMES * FRAME_RAW_LEN <= MAX_FRAME_BLOCK_RAW_LEN,
+        "PICO_LEVEL_METER_NUM_CH * PICO_LEVEL_METER_OVERSAMPLE * PICO_LEVEL_METER_BLOCK_FRAMES must be up to 2041 samples (BLOCK_FRAMES up to 7 with 4 ch and OVERSAMPLE 64)");
+
+    // block size profiles (selected by set_block_profile() before init())
+    enum class block_profile_t {
+        STANDARD = 0,   // PICO_LEVEL_METER_BLOCK_FRAMES
+        LOW_LATENCY,    // PICO_LEVEL_METER_LOW_LATENCY_FRAMES: small blocks at high update rate
+        HIGH_ACCURACY,  // PICO_LEVEL_METER_HIGH_ACCURACY_FRAMES: large blocks with long trimming window
+        NUM_PROFILES
+    };
+    // high-accuracy profile is bounded to the frames of a block sent in a frame of PCM stream
+    static constexpr int HIGH_ACCURACY_FRAMES = std::min(PICO_LEVEL_METER_HIGH_ACCURACY_FRAMES, MAX_FRAME_BLOCK_RAW_LEN / FRAME_RAW_LEN);
+    static constexpr int PROFILE_FRAMES[] = {BLOCK_FRAMES, PICO_LEVEL_METER_LOW_LATENCY_FRAMES, HIGH_ACCURACY_FRAMES};
+    static constexpr int MAX_BLOCK_FRAMES = std::max({PROFILE_FRAMES[0], PROFILE_FRAMES[1], PROFILE_FRAMES[2]});
+    static_assert(std::min({PROFILE_FRAMES[0], PROFILE_FRAMES[1], PROFILE_FRAMES[2]}) >= 2, "frames per block must be 2 or more");
+    static_assert(MAX_BLOCK_FRAMES * FRAME_RAW_LEN <= MAX_FRAME_BLOCK_RAW_LEN,
+        "PICO_LEVEL_METER_NUM_CH * PICO_LEVEL_METER_OVERSAMPLE * PICO_LEVEL_METER_LOW_LATENCY_FRAMES must be up to 2041 samples");
+    static constexpr int MAX_BLOCK_RAW_LEN = MAX_BLOCK_FRAMES * NUM_ADC_CH * PICO_LEVEL_METER_OVERSAMPLE;  // samples of the largest block captured by DMA
+    // buffer size for get_trace_frame() (header and block frames)
+    static constexpr int TRACE_FRAME_SIZE = wire_frame::OVERHEAD * 2 + trace::HEADER_SIZE + trace::block_size(NUM_ADC_CH, MAX_BLOCK_RAW_LEN);
+    static_assert(trace::block_size(NUM_ADC_CH, MAX_BLOCK_RAW_LEN) <= wire_frame::MAX_PAYLOAD, "block is too large for a frame of trace");
+    // buffer size for get_telemetry_frame()
+    static constexpr int TELEMETRY_FRAME_SIZE = wire_frame::OVERHEAD + telemetry::payload_size(NUM_ADC_CH);
+    static constexpr int DEFAULT_TELEMETRY_BATCH = 8;  // level items per frame of telemetry
+
+    // level of a block
+    typedef struct _level_item_t {
+        int id;                    // sequence number of the block
+        int rawValue[NUM_ADC_CH];  // calibrated code (Q8 with oversampling or auto-ranging)
+        int level[NUM_ADC_CH];
+        int peakHold[NUM_ADC_CH];
+    } level_item_t;
+
+    // latency from the first ADC sample of a block to its level item queued for get_level()
+    typedef struct _latency_t {
+        uint32_t block_us;    // duration of a block (the first sample waits for the rest of the block)
+        uint32_t min_us;
+        uint32_t ave_us;
+        uint32_t max_us;
+        uint32_t num_blocks;  // blocks measured
+        bool saturated;       // the average covers only the first num_blocks (sum of latency saturated)
+    } latency_t;
+
+    // request to set the attenuation in front of ADC (called from block processing)
+    typedef void (*range_handler_t)(const int att_db);
+
+    // doorbell when a level item or spectrum is queued (called from block processing, any core)
+    typedef void (*notify_handler_t)();
+
+    // compile-time dB level lookup table for this hardware
+    template <int NUM_LEVELS>
+    using level_lut_t = conv_dB_level_lut<NUM_LEVELS, ADC_BITS, RANGE_RATIO_NUM, RANGE_RATIO_DEN>;
+
     void init(const std::vector<float>& db_scale = conv_dB_level::DEFAULT_DB_SCALE);
+    void init(const uint8_t level_table[]);
+    void init(const uint8_t level_table[], const uint32_t level_threshold[], const int num_levels);
+    template <int NUM_LEVELS>
+    void init(const level_lut_t<NUM_LEVELS>& lut) { init(lut.table(), lut.threshold(), NUM_LEVELS); }
+    void set_sample_rate(const uint32_t rate);  // call before start()
+    void set_block_profile(const block_profile_t profile);  // frames per block (call before init())
+    block_profile_t get_block_profile();
+    int get_block_frames();
+    void set_calib_zero(const int32_t zero[NUM_ADC_CH]);  // stored zero level to skip zero calibration (call before init())
+    bool get_calib_zero(int32_t zero[NUM_ADC_CH]);        // zero level in Q8 of raw ADC code (false until calibrated)
+    void recalibrate();
+    uint32_t get_sample_rate();
+    void set_mode(const meter_mode_t mode);
+    meter_mode_t get_mode();
+    void set_true_peak(const bool enable);
+    bool get_true_peak(float dbtp[NUM_ADC_CH], uint32_t num_over[NUM_ADC_CH]);
+    void clear_overs();
+    void set_loudness(const bool enable);
+    bool get_loudness(lufs_t& lufs);
+    void reset_loudness();
+    void set_stereo(const bool enable);  // correlation, balance and mid/side of the first 2 channels (ignored with 1 channel)
+    bool get_stereo(stereo_t& st);
+    void set_spectrum(const bool enable);
+    void set_spectrum_rate(const uint32_t fps);
+    bool get_spectrum(int level[NUM_BANDS]);
+    uint32_t get_num_skipped_frames();
+    void set_auto_range_scale(const float db_scale[], const int num_levels);  // call before set_auto_range()
+    void set_auto_range(const bool enable, range_handler_t handler = nullptr);
+    bool get_auto_range(int& att_db);
+    void notify_range_switched();  // call when the requested attenuation takes effect (any context)
     void start();
     bool get_level(int level[NUM_ADC_CH], int peak_hold[NUM_ADC_CH] = nullptr);
+    bool get_level(int level[NUM_ADC_CH], int peak_hold[NUM_ADC_CH], int& id, uint32_t& num_dropped);
+    bool get_level_item(level_item_t& item, uint32_t& num_dropped);
+    void set_queue_policy(const overflow_policy_t policy);
+    void set_notify(notify_handler_t handler);  // doorbell to wake the application (nullptr: none)
+    uint32_t get_num_lost_blocks();
+    bool get_latency(latency_t& latency);  // since the last call (false if no block)
+    bool run_flash_access(bool (*func)(), uint32_t& num_lost);  // run func accessing flash without stopping capture
+    void set_trace(const bool enable);  // record raw blocks from the next block (the processing state is reset)
+    int get_trace_frame(uint8_t buf[], const int size);  // frames of a traced block (TRACE_FRAME_SIZE bytes), 0 if none
+    uint32_t get_num_trace_dropped();
+    bool replay_trace(const uint8_t type, const uint8_t payload[], const int len);  // feed a frame of trace in place of capture
+    void set_telemetry(const bool enable, const int batch = DEFAULT_TELEMETRY_BATCH);  // stream every level item (batch: items per frame)
+    int get_telemetry_frame(uint8_t buf[], const int size);  // frame of level items fitting in size bytes, 0 if none
+    uint32_t get_num_telemetry_dropped();
+    void set_pcm_stream(const bool enable);  // stream raw samples of captured blocks from the next block (stops at the end of frame)
+    int get_pcm_data(const uint8_t*& data, const int max_len);  // next bytes of PCM stream (up to max_len) to send before next call, 0 if none
+    bool is_pcm_in_frame();  // a frame of PCM stream is partly sent (no other output may be written until it ends)
+    uint32_t get_num_pcm_overruns();
     void stop();
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "loudness.h"
+
+#include <cmath>
+
+namespace level_meter
+{
+
+loudness::loudness(const int num_ch, const int32_t full_scale) :
+    _num_ch((num_ch > MAX_CH) ? MAX_CH : num_ch), _full_scale(full_scale), _step(1)
+{
+    reset();
+}
+
+void loudness::set_sample_rate(const uint32_t sample_rate)
+{
+    // K-weighting filters of ITU-R BS.1770 for arbitrary sampling rate (bilinear transform)
+    //   a stage whose corner is too close to Nyquist frequency is bypassed
+    constexpr double PI = 3.14159265358979323846;
+    const double fs = static_cast<double>(sample_rate);
+    {
+        const double f0 = 1681.974450955533;
+        const double G  = 3.999843853973347;
+        const double Q  = 0.7071752369554196;
+        if (f0 < fs * 0.45) {
+            const double K  = tan(PI * f0 / fs);
+            const double Vh = pow(10.0, G / 20.0);
+            const double Vb = pow(Vh, 0.4996667741545416);
+            const double a0 = 1.0 + K / Q + K * K;
+            const double b[3] = {(Vh + Vb * K / Q + K * K) / a0, 2.0 * (K * K - Vh) / a0, (Vh - Vb * K / Q + K * K) / a0};
+            const double a[2] = {2.0 * (K * K - 1.0) / a0, (1.0 - K / Q + K * K) / a0};
+            for (int i = 0; i < MAX_CH; i++) { _shelf[i].set_coef(b, a); }
+        } else {
+            const double b[3] = {1.0, 0.0, 0.0};
+            const double a[2] = {0.0, 0.0};
+            for (int i = 0; i < MAX_CH; i++) { _shelf[i].set_coef(b, a); }
+        }
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double Q  = 0.5003270373238773;
+        if (f0 < fs * 0.45) {
+            const double K  = tan(PI * f0 / fs);
+            const double a0 = 1.0 + K / Q + K * K;
+            const double b[3] = {1.0, -2.0, 1.0};
+            const double a[2] = {2.0 * (K * K - 1.0) / a0, (1.0 - K / Q + K * K) / a0};
+            for (int i = 0; i < MAX_CH; i++) { _hpf[i].set_coef(b, a); }
+        } else {
+            const double b[3] = {1.0, 0.0, 0.0};
+            const double a[2] = {0.0, 0.0};
+            for (int i = 0; i < MAX_CH; i++) { _hpf[i].set_coef(b, a); }
+        }
+    }
+    _step = sample_rate * SUB_BLOCK_MS / 1000;
+    if (_step == 0) { _step = 1; }
+    reset();
+}
+
+void loudness::reset()
+{
+    for (int i = 0; i < MAX_CH; i++) {
+        _shelf[i].reset();
+        _hpf[i].reset();
+    }
+    _count = 0;
+    _acc = 0;
+    for (int i = 0; i < SHORT_TERM_SUB_BLOCKS; i++) {
+        _sub[i] = 0;
+    }
+    _sub_idx = 0;
+    _num_sub = 0;
+    _sum_m = 0;
+    _sum_s = 0;
+    _momentary.store(LUFS_FLOOR);
+    _short_term.store(LUFS_FLOOR);
+    for (int i = 0; i < NUM_BINS; i++) {
+        _hist[i].store(0);
+    }
+}
+
+float loudness::_lufs(const int64_t energy, const int num_sub) const
+{
+    // energy = sum of (code << SHIFT_IN)^2 >> SHIFT_SQ, normalized to full scale
+    const double fs = static_cast<double>(_full_scale);
+    const double ms = static_cast<double>(energy) / (static_cast<double>(_step) * num_sub * fs * fs * (1 << (SHIFT_IN * 2 - SHIFT_SQ)));
+    if (ms <= 0.0) { return LUFS_FLOOR; }
+    const float l = -0.691f + 10.0f * log10f(static_cast<float>(ms));
+    return (l < LUFS_FLOOR) ? LUFS_FLOOR : l;
+}
+
+void loudness::_close_sub_block()
+{
+    // O(1) update of running sums (integer, no drift)
+    const int idx_m = (_sub_idx + SHORT_TERM_SUB_BLOCKS - MOMENTARY_SUB_BLOCKS) % SHORT_TERM_SUB_BLOCKS;
+    _sum_m += _acc - _sub[idx_m];
+    _sum_s += _acc - _sub[_sub_idx];
+    _sub[_sub_idx] = _acc;
+    _sub_idx = (_sub_idx + 1) % SHORT_TERM_SUB_BLOCKS;
+    if (_num_sub < SHORT_TERM_SUB_BLOCKS) { _num_sub++; }
+    _acc = 0;
+    _count = 0;
+
+    const float lm = _lufs(_sum_m, MOMENTARY_SUB_BLOCKS);
+    _momentary.store(lm, std::memory_order_relaxed);
+    _short_term.store(_lufs(_sum_s, SHORT_TERM_SUB_BLOCKS), std::memory_order_relaxed);
+
+    // gating block of 400 ms (absolute gate by histogram range)
+    if (_num_sub >= MOMENTARY_SUB_BLOCKS && lm >= HIST_MIN_LUFS) {
+        int bin = static_cast<int>((lm - HIST_MIN_LUFS) * HIST_BINS_PER_LU);
+        if (bin >= NUM_BINS) { bin = NUM_BINS - 1; }
+        _hist[bin].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void loudness::get(lufs_t& lufs) const
+{
+    lufs.momentary = _momentary.load(std::memory_order_relaxed);
+    lufs.short_term = _short_term.load(std::memory_order_relaxed);
+
+    // integrated: relative gate from the mean of the blocks over absolute gate,
+    // bin energies are taken at the center of the bins (stepped by multiplication on FPU)
+    const float E0 = powf(10.0f, (HIST_MIN_LUFS + 0.5f / HIST_BINS_PER_LU) / 10.0f);
+    const float R = powf(10.0f, 1.0f / HIST_BINS_PER_LU / 10.0f);
+    float sum = 0.0f;
+    float n = 0.0f;
+    float e = E0;
+    for (int i = 0; i < NUM_BINS; i++, e *= R) {
+        const uint32_t count = _hist[i].load(std::memory_order_relaxed);
+        if (count == 0) { continue; }
+        sum += count * e;
+        n += count;
+    }
+    if (n == 0.0f) {
+        lufs.integrated = LUFS_FLOOR;
+        return;
+    }
+    const float gate = 10.0f * log10f(sum / n) + RELATIVE_GATE_LU;
+    int start = static_cast<int>(ceilf((gate - HIST_MIN_LUFS) * HIST_BINS_PER_LU - 0.5f));
+    if (start < 0) { start = 0; }
+    sum = 0.0f;
+    n = 0.0f;
+    e = E0 * powf(R, static_cast<float>(start));
+    for (int i = start; i < NUM_BINS; i++, e *= R) {
+        const uint32_t count = _hist[i].load(std::memory_order_relaxed);
+        if (count == 0) { continue; }
+        sum += count * e;
+        n += count;
+    }
+    lufs.integrated = (n > 0.0f) ? 10.0f * log10f(sum / n) : LUFS_FLOOR;
+}
+
+}
@@ -0,0 +1,122 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "dsp_util.h"
+
+namespace level_meter
+{
+/**
+* loudness values in LUFS
+*/
+typedef struct _lufs_t {
+    float momentary;   // 400 ms sliding window
+    float short_term;  // 3 s sliding window
+    float integrated;  // gated integration since reset
+} lufs_t;
+
+/**
+* class for EBU R128 / ITU-R BS.1770 loudness measurement (interleaved multi-channel)
+*
+* Memory and cost are fixed:
+*   per sample and channel: 2 biquads of K-weighting (Q28) and 1 square-accumulate
+*   per 100 ms: O(1) update of 400 ms and 3 s running sums and 1 histogram increment
+*   integrated loudness is gated on a histogram of NUM_BINS counters (0.1 LU steps),
+*   so that the memory stays bounded over unbounded run time.
+* The results can be read from the other core or thread context.
+* The samples must be bipolar for BS.1770 loudness. With full-wave rectified input
+* the result reads lower depending on frequency and level (see README).
+*/
+class loudness
+{
+public:
+    static constexpr int MAX_CH = 4;
+    static constexpr uint32_t SUB_BLOCK_MS = 100;        // gating block step (75% overlap of 400 ms)
+    static constexpr int MOMENTARY_SUB_BLOCKS = 4;       // 400 ms
+    static constexpr int SHORT_TERM_SUB_BLOCKS = 30;     // 3 s
+    static constexpr int HIST_MIN_LUFS = -70;            // absolute gate
+    static constexpr int HIST_MAX_LUFS = 10;
+    static constexpr int HIST_BINS_PER_LU = 10;
+    static constexpr int NUM_BINS = (HIST_MAX_LUFS - HIST_MIN_LUFS) * HIST_BINS_PER_LU;
+    static constexpr float RELATIVE_GATE_LU = -10.0f;
+    static constexpr float LUFS_FLOOR = -99.9f;          // returned for silence
+    static constexpr int SHIFT_IN = 12;                  // calibrated code (12bit) to filter input
+    static constexpr int SHIFT_SQ = 16;                  // squared filter output to energy
+
+    /**
+    * constructor of loudness
+    *
+    * @param[in] num_ch the number of interleaved channels (up to MAX_CH, all weighted by 1.0)
+    * @param[in] full_scale the calibrated ADC code regarded as 0 dBFS
+    */
+    loudness(const int num_ch, const int32_t full_scale);
+
+    /**
+    * set the sampling rate per channel (K-weighting coefficients are computed) and reset
+    *
+    * @param[in] sample_rate the sampling rate in Hz
+    */
+    void set_sample_rate(const uint32_t sample_rate);
+
+    /**
+    * reset the measurement (including integrated loudness)
+    */
+    void reset();
+
+    /**
+    * process interleaved samples
+    *
+    * @param[in] block the interleaved samples
+    * @param[in] len the number of samples per channel
+    * @param[in] gain the calibration gain of each channel (Q16)
+    * @param[in] ofs the calibration offset of each channel in ADC code
+    */
+    inline void process(const uint16_t* block, const int len, const int32_t gain[], const int32_t ofs[])
+    {
+        for (int j = 0; j < len; j++) {
+            for (int i = 0; i < _num_ch; i++) {
+                const int32_t x = dsp::calib(block[j * _num_ch + i], gain[i], ofs[i]) << SHIFT_IN;
+                const int32_t y = _hpf[i].process(_shelf[i].process(x));
+                _acc += (static_cast<int64_t>(y) * y) >> SHIFT_SQ;
+            }
+            if (++_count >= _step) {
+                _close_sub_block();
+            }
+        }
+    }
+
+    /**
+    * get loudness
+    *
+    * @param[out] lufs the momentary, short-term and integrated loudness
+    */
+    void get(lufs_t& lufs) const;
+
+protected:
+    int _num_ch;
+    int32_t _full_scale;
+    uint32_t _step;   // samples per channel in a sub block
+    uint32_t _count;  // samples per channel in the current sub block
+    int64_t _acc;     // energy of the current sub block
+    dsp::biquad _shelf[MAX_CH];  // K-weighting stage 1: high shelf
+    dsp::biquad _hpf[MAX_CH];    // K-weighting stage 2: RLB high-pass
+    int64_t _sub[SHORT_TERM_SUB_BLOCKS];  // energy of recent sub blocks
+    int _sub_idx;
+    int _num_sub;
+    int64_t _sum_m;  // running sum of MOMENTARY_SUB_BLOCKS
+    int64_t _sum_s;  // running sum of SHORT_TERM_SUB_BLOCKS
+    std::atomic<float> _momentary;
+    std::atomic<float> _short_term;
+    std::atomic<uint32_t> _hist[NUM_BINS];  // counts of gating blocks by momentary loudness
+
+    void _close_sub_block();
+    float _lufs(const int64_t energy, const int num_sub) const;
+};
+}
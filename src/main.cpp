@@ -5,33 +5,88 @@
 /------------------------------------------------------*/
 
 #include "level_meter.h"
+#include "adc_capture.h"
 #include "fm62429.h"
 
+#include <cmath>
 #include <cstdio>
 #include <algorithm>
+#include <iterator>
 
 #include "hardware/sync.h"
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include "ConfigParam.h"
+#include "event_loop.h"
 #include "lcd_extra.h"
+#include "lcd_renderer.h"
+#include "cic_decimator.h"
+#include "fft.h"
+#include "perf_stats.h"
+#include "true_peak.h"
+#include "tusb.h"
 
 // dbScale (max - min <= 40, otherwise lowest scale has no meaning against 12bit ADC resolution)
+//   wider span is available with PICO_LEVEL_METER_OVERSAMPLE (e.g. 16 for 2 more bits by CIC decimation)
 //static const std::vector<float> dbScale{-20, -15, -10, -6, -4, -2, 0, 1, 2, 6, 8};  // default
-static const std::vector<float> dbScale{-30, -24, -22, -20, -18, -16, -14, -12, -10, -8, -6, -4, -2, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
-static const int NUM_LEVELS = dbScale.size();
+static constexpr float dbScale[] = {-30, -24, -22, -20, -18, -16, -14, -12, -10, -8, -6, -4, -2, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+static constexpr int NUM_LEVELS = std::size(dbScale);
+static constexpr level_meter::level_lut_t<NUM_LEVELS> dbLevelLut(dbScale);  // built at compile time
+// dbScaleAuto for auto-ranging (60 dB span with attenuator steps, top is the full scale at the maximum attenuation)
+static constexpr float dbScaleAuto[] = {-50, -45, -40, -36, -32, -28, -24, -20, -16, -12, -10, -8, -6, -4, -2, 0, 1, 2, 4, 5, 6, 7, 8, 10};
+static_assert(std::size(dbScaleAuto) == NUM_LEVELS, "dbScaleAuto must have the same steps as dbScale");
+static const float* levelScale = dbScale;  // dB scale in use
 static int greenTh;
 static int redTh;
+static u16 levelColors[NUM_LEVELS];  // color of each segment when on
 
 static bool peakHoldFlag = true;
+static level_meter::meter_mode_t meterMode = level_meter::meter_mode_t::TRIMMED_MEAN;
+static const char* const MeterModeName[] = {"Trimmed mean", "RMS", "VU", "PPM Type I", "PPM Type II", "Sample peak"};
+static level_meter::block_profile_t blockProfile = level_meter::block_profile_t::STANDARD;  // applied at boot
+static const char* const BlockProfileName[] = {"Standard", "Low-latency", "High-accuracy"};
+static bool truePeakFlag = false;
+static float truePeakMaxDb[NUM_ADC_CH];
+static bool loudnessFlag = false;
+static bool stereoFlag = false;
+static constexpr bool StereoAvailable = NUM_ADC_CH >= 2;
+static bool spectrumFlag = false;
+static bool autoRangeFlag = false;
 static const u16 StrColor = GRAY;
+static lcd_renderer* lcd = nullptr;
+static int meterBar[NUM_ADC_CH];
+static int corrBar = -1;  // correlation bar under ch0 and ch1 (centered, -1.0 ~ +1.0)
+static constexpr int CORR_SEGMENTS = NUM_LEVELS;
+static const char* const ChName[] = {"L", "R", "Ch3", "Ch4"};
+static int spectrumBar[level_meter::NUM_BANDS];
 
 static fm62429 *att = nullptr;
 static uint PIN_FM62429_CLOCK = 15;
 static uint PIN_FM62429_DATA  = 14;
-static int attDb[2] = {0, 0};
+static int attDb[2] = {0, 0};  // the attenuator is in front of ch0 and ch1 (auto-ranging up to 2 channels)
+static constexpr bool AutoRangeAvailable = NUM_ADC_CH <= 2;
 static bool bothCh = true;
 static int curCh = 0;;
 
+static uint32_t numDropped = 0;
+static bool traceFlag = false;
+static uint8_t traceBuf[level_meter::TRACE_FRAME_SIZE];
+static bool pcmFlag = false;
+static bool telemetryFlag = false;
+static uint8_t telemetryBuf[level_meter::TELEMETRY_FRAME_SIZE];
+static bool calibSavePending = false;  // save the zero calibration to flash when it is done
+static bool usbConnected = false;
+
+// event-driven main loop (sleeps by WFE between the events)
+static constexpr uint32_t DisplayFps = 50;  // fixed frame rate of display refresh
+static constexpr uint32_t LcdPollUs = 100;  // interval to advance the transfer of LCD in progress
+static event_loop mainLoop;
+static int evLevel = -1;  // doorbell of block processing
+static int evKey = -1;    // USB RX
+static int frameLevel[NUM_ADC_CH];  // levels drawn at the next frame
+static int framePeakHold[NUM_ADC_CH];
+static bool frameUpdated = false;
+
 static inline uint32_t _millis()
 {
     return to_ms_since_boot(get_absolute_time());
@@ -39,32 +94,127 @@ static inline uint32_t _millis()
 
 static void prepareLevel()
 {
+    levelScale = autoRangeFlag ? dbScaleAuto : dbScale;
+    {
+        auto it = std::upper_bound(levelScale, levelScale + NUM_LEVELS, 0);
+        greenTh = std::distance(levelScale, it);
+    }
+    {
+        auto it = std::upper_bound(levelScale, levelScale + NUM_LEVELS, 5);
+        redTh = std::distance(levelScale, it);
+    }
+    for (int i = 0; i < NUM_LEVELS; i++) {
+        levelColors[i] = (i < greenTh) ? GREEN : (i < redTh) ? BRRED : RED;
+    }
+}
+
+static void prepareBars()
+{
+    // level meter (horizontal bar for each channel)
     {
-        auto it = std::upper_bound(dbScale.cbegin(), dbScale.cend(), 0);
-        greenTh = std::distance(dbScale.cbegin(), it);
+        const u16 Y_CH_HEIGHT = 10;
+        const u16 Y_GAP = 6;
+        const u16 Y_CORR_HEIGHT = StereoAvailable ? 5 : 0;  // row of correlation bar below ch1
+        const u16 Y_CORR_BAR = 3;
+        const u16 Y_OFFSET = LCD_H() / 2 - (Y_CH_HEIGHT * NUM_ADC_CH + Y_CORR_HEIGHT) / 2 + Y_GAP / 2;
+        const u16 WIDTH = LCD_W() / NUM_LEVELS;
+        const u16 X_OFFSET = (LCD_W() -  WIDTH * NUM_LEVELS) / 2;
+        const u16 X_GAP = 1;
+        for (int ch = 0; ch < NUM_ADC_CH; ch++) {
+            const u16 y = Y_OFFSET + Y_CH_HEIGHT*ch + ((ch >= 2) ? Y_CORR_HEIGHT : 0);
+            meterBar[ch] = lcd->add_bar(lcd_renderer::orientation_t::HORIZONTAL, X_OFFSET, y, WIDTH-X_GAP, Y_GAP, WIDTH, NUM_LEVELS);
+        }
+        if (StereoAvailable) {
+            corrBar = lcd->add_bar(lcd_renderer::orientation_t::HORIZONTAL, X_OFFSET, Y_OFFSET + Y_CH_HEIGHT*2 - 2, WIDTH-X_GAP, Y_CORR_BAR, WIDTH, CORR_SEGMENTS);
+        }
     }
+    // spectrum (vertical bar for each band)
     {
-        auto it = std::upper_bound(dbScale.cbegin(), dbScale.cend(), 5);
-        redTh = std::distance(dbScale.cbegin(), it);
+        const u16 SEG_H = LCD_H() / NUM_LEVELS;
+        const u16 Y_GAP = 1;
+        const u16 Y_BOTTOM = LCD_H() - (LCD_H() - SEG_H * NUM_LEVELS) / 2;
+        const u16 WIDTH = LCD_W() / level_meter::NUM_BANDS;
+        const u16 X_OFFSET = (LCD_W() - WIDTH * level_meter::NUM_BANDS) / 2;
+        const u16 X_GAP = 1;
+        for (int b = 0; b < level_meter::NUM_BANDS; b++) {
+            spectrumBar[b] = lcd->add_bar(lcd_renderer::orientation_t::VERTICAL, WIDTH*b + X_OFFSET, Y_BOTTOM - SEG_H, WIDTH-X_GAP, SEG_H-Y_GAP, SEG_H, NUM_LEVELS);
+        }
     }
 }
 
 static void drawLevelMeter(int ch, int level, int peakHold = -1)
 {
-    const u16 Y_CH_HEIGHT = 10;
-    const u16 Y_GAP = 6;
-    const u16 Y_OFFSET = LCD_H() / 2 - Y_CH_HEIGHT + Y_GAP / 2;
-    const u16 WIDTH = LCD_W() / NUM_LEVELS;
-    const u16 X_OFFSET = (LCD_W() -  WIDTH * NUM_LEVELS) / 2;
-    const u16 X_GAP = 1;
+    PERF_SCOPE(DRAW_LEVEL_METER);
+    lcd->set_bar(meterBar[ch], level, peakHold, levelColors, DARKGRAY);  // level0 is always on
+}
 
-    for (int i = 0; i < NUM_LEVELS; i++) {
-        if (i == 0 || i < level || i == peakHold) {  // level0 is always on
-            u16 color = (i < greenTh) ? GREEN : (i < redTh) ? BRRED : RED;
-            LCD_Fill(WIDTH*i + X_OFFSET, Y_OFFSET + Y_CH_HEIGHT*ch, WIDTH*i + WIDTH-X_GAP + X_OFFSET - 1, Y_OFFSET + Y_CH_HEIGHT*ch + Y_GAP - 1, color);
-        } else {
-            LCD_Fill(WIDTH*i + X_OFFSET, Y_OFFSET + Y_CH_HEIGHT*ch, WIDTH*i + WIDTH-X_GAP + X_OFFSET - 1, Y_OFFSET + Y_CH_HEIGHT*ch + Y_GAP - 1, DARKGRAY);
-        }
+static void drawCorrelation(const float corr)
+{
+    PERF_SCOPE(DRAW_LEVEL_METER);
+    // filled from the center (green: in phase, red: out of phase)
+    constexpr int HALF = CORR_SEGMENTS / 2;
+    const int n = std::clamp(static_cast<int>(lroundf(corr * HALF)), -HALF, HALF);
+    for (int i = 0; i < CORR_SEGMENTS; i++) {
+        const bool on = (n > 0) ? (i >= HALF && i < HALF + n) : (i < HALF && i >= HALF + n);
+        lcd->set_segment(corrBar, i, on ? ((n > 0) ? GREEN : RED) : DARKGRAY);
+    }
+}
+
+static void clearCorrelation()
+{
+    if (corrBar < 0 || spectrumFlag) { return; }  // spectrum covers the area
+    for (int i = 0; i < CORR_SEGMENTS; i++) {
+        lcd->set_segment(corrBar, i, BLACK);
+    }
+    lcd->flush();
+}
+
+static void drawLevelString(int ch, const char* str)
+{
+    if (spectrumFlag) { return; }  // no string on spectrum
+    if (ch != 0 && ch != NUM_ADC_CH - 1) { return; }  // strings of the first and the last channels (upper and lower)
+    lcd->set_text(8*14, (ch == 0) ? 0 : 16*4, str, StrColor);
+}
+
+static void clearLevelString()
+{
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        drawLevelString(i, "      ");
+    }
+}
+
+static void setRange(const int db)
+{
+    // called from block processing of level meter
+    att->set_att_both(db);
+}
+
+static void setAutoRange(const bool flag)
+{
+    autoRangeFlag = flag;
+    if (!autoRangeFlag) {
+        // back to manual attenuation
+        level_meter::set_auto_range(false);
+        att->set_att(0, attDb[0]);
+        att->set_att(1, attDb[1]);
+    } else {
+        level_meter::set_auto_range(true, setRange);
+    }
+    prepareLevel();
+}
+
+static void clearScreen()
+{
+    lcd->wait();
+    LCD_Clear(BLACK);
+    lcd->invalidate();
+}
+
+static void drawSpectrum(const int level[level_meter::NUM_BANDS])
+{
+    PERF_SCOPE(DRAW_LEVEL_METER);
+    for (int b = 0; b < level_meter::NUM_BANDS; b++) {
+        lcd->set_bar(spectrumBar[b], level[b], -1, levelColors, DARKGRAY);  // level0 is always on
     }
 }
 
@@ -80,18 +230,515 @@ static void printHelp()
     printf(" l: Adjust Left channel for attenuation\r\n");
     printf(" r: Adjust Right channel for attenuation\r\n");
     printf(" p: Toggle peak hold mode\r\n");
+    printf(" m: Change metering mode\r\n");
+    printf(" L: Change block size profile (applied at boot after s)\r\n");
+    printf(" x: Toggle true-peak mode\r\n");
+    printf(" c: Clear true-peak max and overs\r\n");
+    printf(" B: Benchmark DSP kernels (true-peak, CIC and FFT)\r\n");
+    printf(" u: Toggle loudness mode (LUFS)\r\n");
+    printf(" i: Reset integrated loudness\r\n");
+    printf(" k: Toggle stereo correlation, balance and mid/side\r\n");
+    printf(" f: Toggle spectrum analyser\r\n");
+    printf(" a: Toggle auto-ranging by attenuator\r\n");
+    printf(" z: Zero calibration (input is forced to zero, then stored to Flash)\r\n");
+    printf(" w: Toggle trace of raw blocks (binary frames to serial for host/trace_record)\r\n");
+    printf(" o: Toggle level telemetry (binary frames to serial for host/telemetry_record)\r\n");
+    printf(" P: Toggle raw PCM stream of captured samples (binary frames to serial for host/pcm_record)\r\n");
+#if PICO_LEVEL_METER_PERF
+    printf(" t: Dump and reset performance stats\r\n");
+#endif
 }
 
 static void printCurrentSettings()
 {
     printf("[Current settings]\r\n");
-    printf(" L: %d dB, R: %d dB\r\n", static_cast<int>(attDb[0]), static_cast<int>(attDb[1]));
+    printf(" L: %d dB, R: %d dB (coalesced writes: %d)\r\n", static_cast<int>(attDb[0]), static_cast<int>(attDb[1]), static_cast<int>(att->get_num_coalesced()));
     printf(" Peak hold: %s\r\n", peakHoldFlag ? "ON" : "OFF");
+    printf(" Metering mode: %s\r\n", MeterModeName[static_cast<int>(meterMode)]);
+    {
+        const int frames = level_meter::get_block_frames();
+        printf(" Block profile: %s (%d frames, %d blocks/s)", BlockProfileName[static_cast<int>(level_meter::get_block_profile())],
+            frames, static_cast<int>(level_meter::get_sample_rate() / frames));
+        if (blockProfile != level_meter::get_block_profile()) {
+            printf(", %s at boot", BlockProfileName[static_cast<int>(blockProfile)]);
+        }
+        printf("\r\n");
+        level_meter::latency_t lat;
+        if (level_meter::get_latency(lat)) {
+            printf("  latency min: %.1f ms, ave: %.1f ms, max: %.1f ms (block: %.1f ms, %d blocks%s)\r\n",
+                lat.min_us / 1000.0f, lat.ave_us / 1000.0f, lat.max_us / 1000.0f, lat.block_us / 1000.0f, static_cast<int>(lat.num_blocks),
+                lat.saturated ? ", ave of first blocks" : "");
+        }
+    }
+    printf(" True-peak: %s\r\n", truePeakFlag ? "ON" : "OFF");
+    if (truePeakFlag) {
+        printf("  max");
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            printf("%s %s: %.1f dBTP", (i == 0) ? "" : ",", ChName[i], truePeakMaxDb[i]);
+        }
+        printf("\r\n");
+    }
+    printf(" Loudness: %s\r\n", loudnessFlag ? "ON" : "OFF");
+    level_meter::lufs_t lufs;
+    if (level_meter::get_loudness(lufs)) {
+        printf("  M: %.1f LUFS, S: %.1f LUFS, I: %.1f LUFS\r\n", lufs.momentary, lufs.short_term, lufs.integrated);
+    }
+    printf(" Stereo: %s\r\n", stereoFlag ? "ON" : "OFF");
+    level_meter::stereo_t st;
+    if (level_meter::get_stereo(st)) {
+        printf("  correlation: %+.2f, balance: %+.1f dB, M: %.1f dBFS, S: %.1f dBFS\r\n", st.correlation, st.balance, st.mid, st.side);
+    }
+    int rangeDb;
+    if (level_meter::get_auto_range(rangeDb)) {
+        printf(" Auto-ranging: ON (%d dB)\r\n", rangeDb);
+    } else {
+        printf(" Auto-ranging: OFF\r\n");
+    }
+    printf(" Spectrum: %s (skipped frames: %d)\r\n", spectrumFlag ? "ON" : "OFF", static_cast<int>(level_meter::get_num_skipped_frames()));
+    int32_t zero[NUM_ADC_CH];
+    if (level_meter::get_calib_zero(zero)) {
+        printf(" ADC zero");
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            printf("%s %s: %.2f", (i == 0) ? "" : ",", ChName[i], zero[i] / 256.0f);
+        }
+        printf("\r\n");
+    } else {
+        printf(" ADC zero: calibrating\r\n");
+    }
+    printf(" Dropped blocks: %d\r\n", static_cast<int>(numDropped));
+    printf(" Main loop: idle %.1f%% (wake-ups: %d), display %d fps\r\n", mainLoop.get_idle_ratio() * 100.0f, static_cast<int>(mainLoop.get_num_wakeups()), static_cast<int>(DisplayFps));
+    printf(" LCD: %d bytes sent\r\n", static_cast<int>(lcd->get_num_bytes()));
+}
+
+static FlashParamNs::Parameter<int32_t>& cfgAdcZero(const int ch)
+{
+    ConfigParam& cfgParam = ConfigParam::instance();
+    FlashParamNs::Parameter<int32_t>* const params[] = {&cfgParam.P_CFG_ADC_ZERO_L, &cfgParam.P_CFG_ADC_ZERO_R, &cfgParam.P_CFG_ADC_ZERO_CH3, &cfgParam.P_CFG_ADC_ZERO_CH4};
+    return *params[ch];
+}
+
+static void saveSettings()
+{
+    ConfigParam& cfgParam = ConfigParam::instance();
+    cfgParam.P_CFG_ATT_DB_CH_L.set(attDb[0]);
+    cfgParam.P_CFG_ATT_DB_CH_R.set(attDb[1]);
+    cfgParam.P_CFG_PEAK_HOLD_MODE.set(peakHoldFlag);
+    cfgParam.P_CFG_METER_MODE.set(static_cast<int32_t>(meterMode));
+    cfgParam.P_CFG_BLOCK_PROFILE.set(static_cast<int32_t>(blockProfile));
+    cfgParam.P_CFG_TRUE_PEAK.set(truePeakFlag);
+    cfgParam.P_CFG_LOUDNESS.set(loudnessFlag);
+    cfgParam.P_CFG_STEREO.set(stereoFlag);
+    cfgParam.P_CFG_SPECTRUM.set(spectrumFlag);
+    cfgParam.P_CFG_AUTO_RANGE.set(autoRangeFlag);
+    int32_t zero[NUM_ADC_CH];
+    if (level_meter::get_calib_zero(zero)) {
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            cfgAdcZero(i).set(zero[i]);
+        }
+    }
+    att->flush();  // finish the attenuator writes before flash access
+    // capture keeps running, block processing catches up after flash access
+    uint32_t numLost;
+    const uint64_t t0 = time_us_64();
+    const bool result = level_meter::run_flash_access([]() { return ConfigParam::instance().finalize(); }, numLost);
+    const uint32_t ms = static_cast<uint32_t>((time_us_64() - t0) / 1000);
+    if (result) {
+        printf("Save settings to flash successfully (%d ms, lost blocks: %d)\r\n", static_cast<int>(ms), static_cast<int>(numLost));
+    } else {
+        printf("ERROR: failed to save settings to flash\r\n");
+    }
+}
+
+static void printBanner()
+{
+    printf("\r\n");
+    printf("Level Meter (pico_level_meter)\r\n");
+    printCurrentSettings();
+    printHelp();
+}
+
+static void __not_in_flash_func(benchTruePeak)()
+{
+    // true-peak kernel on one core with 1 sec of synthetic samples at the maximum sampling rate of 2 channels
+    constexpr int LEN = 1000;
+    constexpr int NUM_LOOPS = level_meter::adc_capture::SAMPLE_RATE_MAX / LEN;
+    static uint16_t buf[LEN];
+    for (int i = 0; i < LEN; i++) {
+        buf[i] = static_cast<uint16_t>(2048 + 1500 * sinf(0.3f * i));
+    }
+    level_meter::true_peak tp;
+    uint32_t numOver;
+    const uint64_t t0 = time_us_64();
+    for (int i = 0; i < NUM_LOOPS; i++) {
+        tp.process(buf, 1, LEN, 1 << 16, 0, 4095, numOver);
+    }
+    const uint64_t us = time_us_64() - t0;
+    const float cyclesPerSample = static_cast<float>(us) * (clock_get_hz(clk_sys) / 1000000) / (LEN * NUM_LOOPS);
+    printf("true_peak: %.1f cycles/sample, %d us for 1 sec of %d KS/s (%.1f%% of one core)\r\n",
+        cyclesPerSample, static_cast<int>(us), static_cast<int>(level_meter::adc_capture::SAMPLE_RATE_MAX / 1000), us / 1e4f);
+}
+
+static void __not_in_flash_func(benchCic)()
+{
+    // CIC decimation kernel on one core with 1 sec of synthetic samples at the maximum sampling rate of 2 channels
+    constexpr int R = 16;
+    constexpr int LEN = 1024;  // input samples
+    constexpr int NUM_LOOPS = level_meter::adc_capture::SAMPLE_RATE_MAX / LEN;
+    static uint16_t buf[LEN];
+    static int32_t out[LEN / R];
+    for (int i = 0; i < LEN; i++) {
+        buf[i] = static_cast<uint16_t>(2048 + 1500 * sinf(0.01f * i));
+    }
+    level_meter::cic_decimator<R> cic;
+    const uint64_t t0 = time_us_64();
+    for (int i = 0; i < NUM_LOOPS; i++) {
+        cic.process(buf, 1, LEN / R, out, 1);
+    }
+    const uint64_t us = time_us_64() - t0;
+    const float cyclesPerSample = static_cast<float>(us) * (clock_get_hz(clk_sys) / 1000000) / (LEN * NUM_LOOPS);
+    printf("cic%d: %.1f cycles/input sample, %d us for 1 sec of %d KS/s (%.1f%% of one core)\r\n",
+        R, cyclesPerSample, static_cast<int>(us), static_cast<int>(level_meter::adc_capture::SAMPLE_RATE_MAX / 1000), us / 1e4f);
+}
+
+static void __not_in_flash_func(benchFft)()
+{
+    // FFT kernel on one core against the frame budget of spectrum analyser
+    constexpr int N = level_meter::spectrum::FFT_SIZE;
+    constexpr int NUM_LOOPS = 1000;
+    static level_meter::fft_radix4<N> fft;
+    static uint32_t buf[N];
+    uint64_t us = 0;
+    for (int i = 0; i < NUM_LOOPS; i++) {
+        for (int k = 0; k < N; k++) {
+            buf[k] = level_meter::dsp::pack(static_cast<int32_t>(16000 * sinf(0.3f * k)), 0);
+        }
+        const uint64_t t0 = time_us_64();
+        fft.forward(buf);
+        us += time_us_64() - t0;
+    }
+    const float cycles = static_cast<float>(us) * (clock_get_hz(clk_sys) / 1000000) / NUM_LOOPS;
+    printf("fft%d: %.0f cycles/frame (%.1f%% of one core at %d fps)\r\n",
+        N, cycles, cycles * level_meter::DEFAULT_SPECTRUM_RATE * 100.0f / clock_get_hz(clk_sys), static_cast<int>(level_meter::DEFAULT_SPECTRUM_RATE));
+}
+
+static void handleKey(const char c)
+{
+    if (c == 'h') {
+        printHelp();
+    } else if (c == ' ') {
+        printCurrentSettings();
+    } else if (c == 's') {
+        saveSettings();
+    } else if (c == 'z') {
+        level_meter::recalibrate();
+        calibSavePending = true;
+        printf("Zero calibration (keep input silent)\r\n");
+    } else if (c == 'p') {
+        peakHoldFlag = !peakHoldFlag;
+        clearLevelString();
+        if (peakHoldFlag) {
+            printf("Peak hold: ON\r\n");
+        } else {
+            printf("Peak hold: OFF\r\n");
+        }
+    } else if (c == 'm') {
+        meterMode = static_cast<level_meter::meter_mode_t>((static_cast<int>(meterMode) + 1) % static_cast<int>(level_meter::meter_mode_t::NUM_MODES));
+        level_meter::set_mode(meterMode);
+        printf("Metering mode: %s\r\n", MeterModeName[static_cast<int>(meterMode)]);
+    } else if (c == 'L') {
+        blockProfile = static_cast<level_meter::block_profile_t>((static_cast<int>(blockProfile) + 1) % static_cast<int>(level_meter::block_profile_t::NUM_PROFILES));
+        printf("Block profile: %s (applied at boot after s)\r\n", BlockProfileName[static_cast<int>(blockProfile)]);
+    } else if (c == 'x') {
+        truePeakFlag = !truePeakFlag;
+        level_meter::set_true_peak(truePeakFlag);
+        printf("True-peak: %s\r\n", truePeakFlag ? "ON" : "OFF");
+    } else if (c == 'c') {
+        level_meter::clear_overs();
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            truePeakMaxDb[i] = -99.9f;
+        }
+        clearLevelString();
+        printf("Clear true-peak max and overs\r\n");
+    } else if (c == 'B') {
+        benchTruePeak();
+        benchCic();
+        benchFft();
+    } else if (c == 'u') {
+        loudnessFlag = !loudnessFlag;
+        level_meter::set_loudness(loudnessFlag);
+        clearLevelString();
+        printf("Loudness: %s\r\n", loudnessFlag ? "ON" : "OFF");
+    } else if (c == 'k' && !StereoAvailable) {
+        printf("Stereo: not available with %d channel\r\n", NUM_ADC_CH);
+    } else if (c == 'k') {
+        stereoFlag = !stereoFlag;
+        level_meter::set_stereo(stereoFlag);
+        if (!stereoFlag) { clearCorrelation(); }
+        printf("Stereo: %s\r\n", stereoFlag ? "ON" : "OFF");
+    } else if (c == 'f') {
+        spectrumFlag = !spectrumFlag;
+        level_meter::set_spectrum(spectrumFlag);
+        clearScreen();
+        printf("Spectrum: %s\r\n", spectrumFlag ? "ON" : "OFF");
+    } else if (c == 'a' && !AutoRangeAvailable) {
+        printf("Auto-ranging: not available with %d channels\r\n", NUM_ADC_CH);
+    } else if (c == 'a') {
+        setAutoRange(!autoRangeFlag);
+        clearLevelString();
+        printf("Auto-ranging: %s\r\n", autoRangeFlag ? "ON" : "OFF");
+    } else if (c == 'i') {
+        level_meter::reset_loudness();
+        printf("Reset integrated loudness\r\n");
+    } else if (c == 'w') {
+        traceFlag = !traceFlag;
+        level_meter::set_trace(traceFlag);
+        printf("Trace: %s (dropped blocks: %d)\r\n", traceFlag ? "ON" : "OFF", static_cast<int>(level_meter::get_num_trace_dropped()));
+    } else if (c == 'o') {
+        telemetryFlag = !telemetryFlag;
+        level_meter::set_telemetry(telemetryFlag);
+        printf("Telemetry: %s (dropped items: %d)\r\n", telemetryFlag ? "ON" : "OFF", static_cast<int>(level_meter::get_num_telemetry_dropped()));
+    } else if (c == 'P') {
+        pcmFlag = !pcmFlag;
+        level_meter::set_pcm_stream(pcmFlag);
+        printf("PCM stream: %s (overruns: %d)\r\n", pcmFlag ? "ON" : "OFF", static_cast<int>(level_meter::get_num_pcm_overruns()));
+    } else if (c == 't') {
+        level_meter::perf_stats::dump_and_reset();
+    } else if (c == 'b') {
+        bothCh = true;
+        curCh = 0;
+        printf("Ch: both\r\n");
+    } else if (c == 'l') {
+        bothCh = false;
+        curCh = 0;
+        printf("Ch: L\r\n");
+    } else if (c == 'r') {
+        bothCh = false;
+        curCh = 1;
+        printf("Ch: R\r\n");
+    } else if ((c == '+' || c == '=' || c == '-') && autoRangeFlag) {
+        printf("Attenuation is controlled by auto-ranging\r\n");
+    } else if (c == '+' || c == '=') {
+        if (attDb[curCh] < fm62429::DB_MAX) {
+            attDb[curCh] += 1;
+        }
+        if (bothCh) {
+            att->set_att_both(attDb[curCh]);
+            attDb[1 - curCh] = attDb[curCh];
+        } else {
+            att->set_att(curCh, attDb[curCh]);
+        }
+        printf("L: %d dB, R: %d dB\r\n", static_cast<int>(attDb[0]), static_cast<int>(attDb[1]));
+    } else if (c == '-') {
+        if (attDb[curCh] > fm62429::DB_MIN) {
+            attDb[curCh] -= 1;
+        }
+        if (bothCh) {
+            att->set_att_both(attDb[curCh]);
+            attDb[1 - curCh] = attDb[curCh];
+        } else {
+            att->set_att(curCh, attDb[curCh]);
+        }
+        printf("L: %d dB, R: %d dB\r\n", static_cast<int>(attDb[0]), static_cast<int>(attDb[1]));
+    }
+
+}
+
+// samples are sent from DMA ring in place, in pieces fitting in the room of USB CDC not to block
+static void sendPcm()
+{
+    const uint8_t* data;
+    int len;
+    while ((len = level_meter::get_pcm_data(data, static_cast<int>(tud_cdc_write_available()))) > 0) {
+        stdio_put_string(reinterpret_cast<const char*>(data), len, false, false);
+    }
+}
+
+static void sendStreams()
+{
+    // the rest of PCM frame goes first, since the other frames would break into it
+    if (level_meter::is_pcm_in_frame()) {
+        sendPcm();
+        if (level_meter::is_pcm_in_frame()) { return; }  // no room of USB CDC
+    }
+    if (traceFlag) {
+        // binary frames without CR/LF translation (blocks are dropped in IRQ if serial is too slow)
+        int len;
+        while ((len = level_meter::get_trace_frame(traceBuf, sizeof(traceBuf))) > 0) {
+            stdio_put_string(reinterpret_cast<const char*>(traceBuf), len, false, false);
+        }
+    }
+    if (telemetryFlag) {
+        // frames fit in the room of USB CDC not to block (level items are dropped in IRQ while serial is slow)
+        int len;
+        while ((len = level_meter::get_telemetry_frame(telemetryBuf, std::min(static_cast<int>(tud_cdc_write_available()), static_cast<int>(sizeof(telemetryBuf))))) > 0) {
+            stdio_put_string(reinterpret_cast<const char*>(telemetryBuf), len, false, false);
+        }
+    }
+    sendPcm();
+}
+
+static void drawLevels()
+{
+    float dbtp[NUM_ADC_CH];
+    uint32_t numOver[NUM_ADC_CH];
+    const bool tpFlag = level_meter::get_true_peak(dbtp, numOver);
+    level_meter::lufs_t lufs;
+    const bool luFlag = level_meter::get_loudness(lufs);
+    level_meter::stereo_t st;
+    if (level_meter::get_stereo(st)) {
+        drawCorrelation(st.correlation);
+    }
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        if (tpFlag) {
+            truePeakMaxDb[i] = std::max(truePeakMaxDb[i], dbtp[i]);
+        }
+        if (luFlag) {
+            // loudness in place of peak text (upper: momentary, lower: integrated)
+            drawLevelMeter(i, frameLevel[i], peakHoldFlag ? framePeakHold[i] : -1);
+            char str[10];
+            sprintf(str, "%c%5.1f", (i == 0) ? 'M' : 'I', (i == 0) ? lufs.momentary : lufs.integrated);
+            drawLevelString(i, str);
+        } else if (tpFlag && numOver[i] > 0) {
+            // sticky over by true-peak until cleared
+            drawLevelMeter(i, frameLevel[i], peakHoldFlag ? framePeakHold[i] : -1);
+            drawLevelString(i, " OVER ");
+        } else if (peakHoldFlag) {
+            drawLevelMeter(i, frameLevel[i], framePeakHold[i]);
+            // display level by string
+            if (framePeakHold[i] > 0) {
+                if (framePeakHold[i] < NUM_LEVELS) {
+                    char str[10];
+                    sprintf(str, "%4ddB", static_cast<int>(levelScale[framePeakHold[i]]));
+                    drawLevelString(i, str);
+                } else {
+                    drawLevelString(i, " OVER ");
+                }
+            } else {
+                drawLevelString(i, "      ");
+            }
+        } else {
+            drawLevelMeter(i, frameLevel[i]);
+        }
+    }
+}
+
+// doorbell of block processing: the level items are folded into the next frame of display
+static void onLevel()
+{
+    int level[NUM_ADC_CH];
+    int peakHold[NUM_ADC_CH];
+    int id;
+    while (level_meter::get_level(level, peakHold, id, numDropped)) {
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            frameLevel[i] = frameUpdated ? std::max(frameLevel[i], level[i]) : level[i];  // maximum since the last frame
+            framePeakHold[i] = peakHold[i];
+        }
+        frameUpdated = true;
+    }
+    if (calibSavePending) {
+        int32_t zero[NUM_ADC_CH];
+        if (level_meter::get_calib_zero(zero)) {
+            calibSavePending = false;
+            saveSettings();
+        }
+    }
+    sendStreams();
+}
+
+// USB RX
+static void onKey()
+{
+    int chr;
+    while ((chr = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        handleKey(static_cast<char>(chr));
+    }
+}
+
+// display refresh at the fixed frame rate
+static void onDisplay()
+{
+    // initial settings are printed when serial is connected (no wait for connection)
+    if (!usbConnected && stdio_usb_connected()) {
+        usbConnected = true;
+        printBanner();
+        getchar_timeout_us(1000);  // discard input
+    }
+    sendStreams();  // the room of USB CDC freed since the last block
+    if (spectrumFlag) {
+        int bandLevel[level_meter::NUM_BANDS];
+        if (level_meter::get_spectrum(bandLevel)) {
+            drawSpectrum(bandLevel);
+            lcd->flush();
+        }
+    } else if (frameUpdated) {
+        drawLevels();
+        lcd->flush();
+    }
+    frameUpdated = false;
 }
 
 int main()
 {
     stdio_init_all();
+    level_meter::perf_stats::init();
+
+    // Load configuration from Flash
+    ConfigParam& cfgParam = ConfigParam::instance();
+    cfgParam.initialize();
+    attDb[0] = cfgParam.P_CFG_ATT_DB_CH_L.get();
+    attDb[1] = cfgParam.P_CFG_ATT_DB_CH_R.get();
+    peakHoldFlag = cfgParam.P_CFG_PEAK_HOLD_MODE.get();
+    {
+        int mode = cfgParam.P_CFG_METER_MODE.get();
+        if (mode < 0 || mode >= static_cast<int>(level_meter::meter_mode_t::NUM_MODES)) { mode = 0; }
+        meterMode = static_cast<level_meter::meter_mode_t>(mode);
+    }
+    {
+        int profile = cfgParam.P_CFG_BLOCK_PROFILE.get();
+        if (profile < 0 || profile >= static_cast<int>(level_meter::block_profile_t::NUM_PROFILES)) { profile = 0; }
+        blockProfile = static_cast<level_meter::block_profile_t>(profile);
+    }
+    truePeakFlag = cfgParam.P_CFG_TRUE_PEAK.get();
+    loudnessFlag = cfgParam.P_CFG_LOUDNESS.get();
+    stereoFlag = cfgParam.P_CFG_STEREO.get() && StereoAvailable;
+    spectrumFlag = cfgParam.P_CFG_SPECTRUM.get();
+    autoRangeFlag = cfgParam.P_CFG_AUTO_RANGE.get() && AutoRangeAvailable;
+    for (int i = 0; i < NUM_ADC_CH; i++) {
+        truePeakMaxDb[i] = -99.9f;
+    }
+    {
+        // stored zero calibration skips the forced zero phase (warm boot)
+        int32_t zero[NUM_ADC_CH];
+        bool stored = true;
+        for (int i = 0; i < NUM_ADC_CH; i++) {
+            zero[i] = cfgAdcZero(i).get();
+            stored = stored && zero[i] >= 0;
+        }
+        if (stored) {
+            level_meter::set_calib_zero(zero);
+        } else {
+            calibSavePending = true;
+        }
+    }
+
+    // Electronic volume (FM62429)
+    att = new fm62429(PIN_FM62429_CLOCK, PIN_FM62429_DATA);
+    att->init();
+    att->set_att(0, attDb[0]);
+    att->set_att(1, attDb[1]);
+    att->set_done_callback(level_meter::notify_range_switched);
+
+    // level meter (capture runs during LCD initialization)
+    level_meter::set_block_profile(blockProfile);
+    level_meter::set_mode(meterMode);
+    level_meter::set_true_peak(truePeakFlag);
+    level_meter::set_loudness(loudnessFlag);
+    level_meter::set_stereo(stereoFlag);
+    level_meter::set_spectrum(spectrumFlag);
+    level_meter::set_auto_range_scale(dbScaleAuto, NUM_LEVELS);
+    level_meter::init(dbLevelLut);
+    level_meter::start();
+    setAutoRange(autoRangeFlag);
 
     pico_st7735_80x160_config_t lcd_cfg = {
         SPI_CLK_FREQ_DEFAULT,
@@ -116,126 +763,22 @@ int main()
     LCD_SetRotation(1);
     LCD_Clear(BLACK);
     BACK_COLOR=BLACK;
+    lcd = new lcd_renderer(spi1, PIN_LCD_SPI1_CS_WAVESHARE, PIN_LCD_DC_WAVESHARE, BLACK);
+    lcd->init();
+    prepareBars();
 
-    // Load configuration from Flash
-    ConfigParam& cfgParam = ConfigParam::instance();
-    cfgParam.initialize();
-    attDb[0] = cfgParam.P_CFG_ATT_DB_CH_L.get();
-    attDb[1] = cfgParam.P_CFG_ATT_DB_CH_R.get();
-    peakHoldFlag = cfgParam.P_CFG_PEAK_HOLD_MODE.get();
-
-    // Electronic volume (FM62429)
-    att = new fm62429(PIN_FM62429_CLOCK, PIN_FM62429_DATA);
-    att->init();
-    att->set_att(0, attDb[0]);
-    att->set_att(1, attDb[1]);
-
-    // level meter
-    int level[NUM_ADC_CH];
-    int peakHold[NUM_ADC_CH];
-    level_meter::init(dbScale);
-    level_meter::start();
-    prepareLevel();
-
-    // serial connection waiting (max 1 sec)
-    while (!stdio_usb_connected() && _millis() < 1000) {
-        sleep_ms(100);
-    }
-
-    // Print initial settings
-    printf("\r\n");
-    printf("Level Meter (pico_level_meter)\r\n");
-    printCurrentSettings();
-    printHelp();
-
-    getchar_timeout_us(1000);  // discard input
+    // capture path, USB RX and display refresh wake the loop sleeping by WFE
+    evLevel = mainLoop.add(onLevel);
+    evKey = mainLoop.add(onKey);
+    mainLoop.add_periodic(onDisplay, 1000000 / DisplayFps);
+    level_meter::set_notify([]() { mainLoop.post(evLevel); });
+    stdio_set_chars_available_callback([](void*) { mainLoop.post(evKey); }, nullptr);
+    mainLoop.post(evKey);  // input before registration of the callback
 
     while (true) {
-        int chr;
-        if ((chr = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {  // any key to toggle peakHold
-            char c = static_cast<char>(chr);
-            if (c == 'h') {
-                printHelp();
-            } else if (c == ' ') {
-                printCurrentSettings();
-            } else if (c == 's') {
-                cfgParam.P_CFG_ATT_DB_CH_L.set(attDb[0]);
-                cfgParam.P_CFG_ATT_DB_CH_R.set(attDb[1]);
-                cfgParam.P_CFG_PEAK_HOLD_MODE.set(peakHoldFlag);
-                level_meter::stop();
-                if (cfgParam.finalize()) {
-                    printf("Save settings to flash successfully\r\n");
-                } else {
-                    printf("ERROR: failed to save settings to flash\r\n");
-                }
-                level_meter::start();
-            } else if (c == 'p') {
-                peakHoldFlag = !peakHoldFlag;
-                for (int i = 0; i < NUM_ADC_CH; i++) {
-                    LCD_ShowString(8*14, i*16*4, reinterpret_cast<const u8*>("      "), StrColor);
-                }
-                if (peakHoldFlag) {
-                    printf("Peak hold: ON\r\n");
-                } else {
-                    printf("Peak hold: OFF\r\n");
-                }
-            } else if (c == 'b') {
-                bothCh = true;
-                curCh = 0;
-                printf("Ch: both\r\n");
-            } else if (c == 'l') {
-                bothCh = false;
-                curCh = 0;
-                printf("Ch: L\r\n");
-            } else if (c == 'r') {
-                bothCh = false;
-                curCh = 1;
-                printf("Ch: R\r\n");
-            } else if (c == '+' || c == '=') {
-                if (attDb[curCh] < fm62429::DB_MAX) {
-                    attDb[curCh] += 1;
-                }
-                if (bothCh) {
-                    att->set_att_both(attDb[curCh]);
-                    attDb[1 - curCh] = attDb[curCh];
-                } else {
-                    att->set_att(curCh, attDb[curCh]);
-                }
-                printf("L: %d dB, R: %d dB\r\n", static_cast<int>(attDb[0]), static_cast<int>(attDb[1]));
-            } else if (c == '-') {
-                if (attDb[curCh] > fm62429::DB_MIN) {
-                    attDb[curCh] -= 1;
-                }
-                if (bothCh) {
-                    att->set_att_both(attDb[curCh]);
-                    attDb[1 - curCh] = attDb[curCh];
-                } else {
-                    att->set_att(curCh, attDb[curCh]);
-                }
-                printf("L: %d dB, R: %d dB\r\n", static_cast<int>(attDb[0]), static_cast<int>(attDb[1]));
-            }
-        }
-        if (level_meter::get_level(level, peakHold)) {
-            for (int i = 0; i < NUM_ADC_CH; i++) {
-                if (peakHoldFlag) {
-                    drawLevelMeter(i, level[i], peakHold[i]);
-                    // display level by string
-                    if (peakHold[i] > 0) {
-                        if (peakHold[i] < NUM_LEVELS) {
-                            char str[10];
-                            sprintf(str, "%4ddB", static_cast<int>(dbScale[peakHold[i]]));
-                            LCD_ShowString(8*14, i*16*4, reinterpret_cast<const u8*>(str), StrColor);
-                        } else {
-                            LCD_ShowString(8*14, i*16*4, reinterpret_cast<const u8*>(" OVER "), StrColor);
-                        }
-                    } else {
-                        LCD_ShowString(8*14, i*16*4, reinterpret_cast<const u8*>("      "), StrColor);
-                    }
-                } else {
-                    drawLevelMeter(i, level[i]);
-                }
-            }
-        }
+        lcd->poll();
+        // transfer of LCD in progress is advanced at short interval (not waiting for the next frame)
+        mainLoop.dispatch(lcd->busy() ? LcdPollUs : event_loop::NO_TIMEOUT);
     }
 
     sleep_ms(100);
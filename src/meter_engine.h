@@ -0,0 +1,392 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ballistics.h"
+#include "cic_decimator.h"
+#include "conv_dB_level.h"
+#include "dsp_util.h"
+#include "peak_hold.h"
+#include "perf_stats.h"
+#include "trimmed_mean.h"
+
+namespace level_meter
+{
+/**
+* metering engine of interleaved multi-channel blocks
+*
+* A block of captured samples is turned into the calibrated code, the dB level and the peak hold
+* of each channel: decimation by CIC (OVERSAMPLE > 1), trimmed mean (mean of decimated samples
+* with oversampling) or per-sample ballistics of the metering mode, dB level conversion and
+* time based peak hold. All the buffers are sized by the template parameters (no heap),
+* and the cost of a block is proportional to NUM_CH. The frames of a block can be set
+* up to BLOCK_FRAMES at run time (set_block_frames()).
+* An instance has the whole state of a meter, so that any number of meters can run side by side.
+*
+* @tparam NUM_CH the number of interleaved channels (1 ~ MAX_CH)
+* @tparam BLOCK_FRAMES the maximum number of frames per block (after decimation)
+* @tparam OVERSAMPLE the oversampling ratio of captured samples (power of 2 up to 64, 1: no oversampling)
+* @tparam ADC_BITS the resolution of captured samples
+*/
+template <int NUM_CH, int BLOCK_FRAMES, int OVERSAMPLE = 1, int ADC_BITS = 12>
+class meter_engine
+{
+public:
+    static constexpr int MAX_CH = 4;  // ADC inputs of RP2350
+    static_assert(NUM_CH >= 1 && NUM_CH <= MAX_CH, "NUM_CH must be 1 ~ MAX_CH");
+    static_assert(OVERSAMPLE >= 1 && (OVERSAMPLE & (OVERSAMPLE - 1)) == 0, "OVERSAMPLE must be power of 2");
+
+    static constexpr int BLOCK_LEN = BLOCK_FRAMES * NUM_CH;  // decimated samples of the largest block (all channels)
+    static constexpr int RAW_LEN = BLOCK_LEN * OVERSAMPLE;   // captured samples of the largest block (all channels)
+    static constexpr int CODE_FRAC = (OVERSAMPLE > 1) ? 8 : 0;  // fractional bits of code for dB level conversion
+    static constexpr int ADC_MAX = (1 << ADC_BITS) - 1;
+    static constexpr int32_t GAIN_UNITY = 1 << 16;  // calibrated code = ((raw * gain) >> 16) + ofs
+    static constexpr int NUM_MODES = static_cast<int>(meter_mode_t::NUM_MODES);
+    static constexpr uint32_t PEAK_HOLD_MS = 1000;
+
+    using trimmed_mean_t = trimmed_mean<BLOCK_LEN, NUM_CH>;
+
+    /**
+    * constructor of meter_engine
+    *
+    * @param[in] range_ratio the ratio of the top of dB scale to the full scale of ADC
+    */
+    meter_engine(const float range_ratio) :
+        _range_ratio(range_ratio), _table(nullptr), _threshold(nullptr), _num_levels(0), _conv(nullptr),
+        _frames(BLOCK_FRAMES), _num_ave(trimmed_mean_t::NUM_AVE), _rate(500)
+    {
+        for (int i = 0; i < NUM_CH; i++) {
+            set_calib(i, GAIN_UNITY, 0);
+        }
+        set_sample_rate(500, meter_mode_t::TRIMMED_MEAN);
+    }
+
+    /**
+    * set dB level conversion by lookup table
+    *
+    * @param[in] table the level indexed by calibrated code (ADC_MAX + 1 entries)
+    * @param[in] threshold the thresholds of the table in Q8 of calibrated code (nullptr: codes with fractional bits are rounded)
+    * @param[in] num_levels the number of thresholds
+    */
+    void set_level_table(const uint8_t table[], const uint32_t threshold[] = nullptr, const int num_levels = 0)
+    {
+        _table = table;
+        _threshold = threshold;
+        _num_levels = num_levels;
+    }
+
+    /**
+    * set dB level conversion by floating point (used without lookup table)
+    *
+    * @param[in] conv the converter of NUM_CH channels
+    */
+    void set_level_conv(conv_dB_level* conv) { _conv = conv; }
+
+    const uint8_t* get_level_table() const { return _table; }
+    const uint32_t* get_level_threshold() const { return _threshold; }
+    int get_num_levels() const { return _num_levels; }
+
+    /**
+    * set sampling rate (the state of ballistics is reset)
+    *
+    * @param[in] rate sampling rate per channel in Hz (after decimation)
+    * @param[in] mode the metering mode to apply
+    */
+    void set_sample_rate(const uint32_t rate, const meter_mode_t mode)
+    {
+        _rate = rate;
+        for (int m = 0; m < NUM_MODES; m++) {
+            _coef[m] = ballistics::get_coef(static_cast<meter_mode_t>(m), rate);
+        }
+        reset_ballistics(mode);
+        _peak_hold.set_hold_blocks(PEAK_HOLD_MS * rate / (1000 * _frames));
+    }
+
+    /**
+    * set the number of frames per block (call before processing, the peak hold time is kept)
+    *
+    * @param[in] frames frames per block (2 ~ BLOCK_FRAMES)
+    */
+    void set_block_frames(const int frames)
+    {
+        _frames = (frames < 2) ? 2 : (frames > BLOCK_FRAMES) ? BLOCK_FRAMES : frames;
+        _num_ave = trimmed_mean_t::num_ave(_frames);
+        _peak_hold.set_hold_blocks(PEAK_HOLD_MS * _rate / (1000 * _frames));
+    }
+
+    int get_block_frames() const { return _frames; }
+    int get_block_len() const { return _frames * NUM_CH; }
+    int get_raw_len() const { return _frames * NUM_CH * OVERSAMPLE; }
+
+    /**
+    * get ballistics coefficients of the mode for current sampling rate
+    *
+    * @param[in] mode the metering mode
+    * @return the coefficients
+    */
+    const ballistics::coef_t& get_coef(const meter_mode_t mode) const { return _coef[static_cast<int>(mode)]; }
+
+    /**
+    * override ballistics coefficients of the mode (applied at next mode change or reset)
+    *
+    * @param[in] mode the metering mode
+    * @param[in] k_att attack coefficient (Q30)
+    * @param[in] k_rel release coefficient (Q30)
+    */
+    void set_coef(const meter_mode_t mode, const int32_t k_att, const int32_t k_rel)
+    {
+        _coef[static_cast<int>(mode)].k_att = k_att;
+        _coef[static_cast<int>(mode)].k_rel = k_rel;
+    }
+
+    /**
+    * set calibration of the channel
+    *
+    * @param[in] ch the channel
+    * @param[in] gain the gain (Q16)
+    * @param[in] ofs the offset in ADC code
+    */
+    void set_calib(const int ch, const int32_t gain, const int32_t ofs)
+    {
+        _gain[ch] = gain;
+        _ofs[ch] = ofs;
+    }
+
+    const int32_t* get_gain() const { return _gain; }
+    const int32_t* get_ofs() const { return _ofs; }
+
+    /**
+    * reset the state which depends on the past blocks (ballistics, CIC and peak hold)
+    *
+    * @param[in] mode the metering mode to apply
+    */
+    void reset(const meter_mode_t mode)
+    {
+        reset_ballistics(mode);
+        if constexpr (OVERSAMPLE > 1) {
+            for (int i = 0; i < NUM_CH; i++) {
+                _cic[i].reset();
+            }
+        }
+        _peak_hold.reset();
+    }
+
+    /**
+    * reset the state of ballistics
+    *
+    * @param[in] mode the metering mode to apply
+    */
+    void reset_ballistics(const meter_mode_t mode)
+    {
+        for (int i = 0; i < NUM_CH; i++) {
+            _ballistics[i].set_coef(_coef[static_cast<int>(mode)]);
+        }
+    }
+
+    /**
+    * apply the metering mode (the state of ballistics is reset if changed)
+    *
+    * @param[in] mode the metering mode
+    */
+    inline void set_mode(const meter_mode_t mode)
+    {
+        if (mode != _ballistics[0].get_mode()) {
+            reset_ballistics(mode);
+        }
+    }
+
+    meter_mode_t get_mode() const { return _ballistics[0].get_mode(); }
+
+    ballistics& get_ballistics(const int ch) { return _ballistics[ch]; }
+
+    /**
+    * front end of captured block (decimation with oversampling)
+    *
+    * @param[in] raw the captured samples (get_raw_len())
+    * @return the samples of ADC code (get_block_len(), valid until next call)
+    */
+    inline const uint16_t* front_end(const uint16_t* raw)
+    {
+        if constexpr (OVERSAMPLE > 1) {
+            PERF_SCOPE(DECIMATE);
+            for (int i = 0; i < NUM_CH; i++) {
+                _cic[i].process(&raw[i], NUM_CH, _frames, &_hr_block[i], NUM_CH);
+            }
+            const int len = _frames * NUM_CH;
+            for (int k = 0; k < len; k++) {
+                const int32_t c = (_hr_block[k] + (1 << (dsp::HR_FRAC - 1))) >> dsp::HR_FRAC;
+                _dec_block[k] = static_cast<uint16_t>((c > ADC_MAX) ? ADC_MAX : c);
+            }
+            return _dec_block;
+        } else {
+            return raw;
+        }
+    }
+
+    /**
+    * calibrated code by the mean of the block (trimmed mean, or mean of decimated samples with oversampling)
+    *
+    * @param[in] block the samples from front_end()
+    * @param[out] code the code of each channel (CODE_FRAC bits)
+    */
+    inline void get_mean_code(const uint16_t* block, int32_t code[NUM_CH]) const
+    {
+        if constexpr (OVERSAMPLE > 1) {
+            // CIC has already removed the noise which trimmed mean rejects
+            (void)block;
+            for (int i = 0; i < NUM_CH; i++) {
+                int32_t sum = 0;
+                for (int j = 0; j < _frames; j++) {
+                    sum += _hr_block[j * NUM_CH + i];
+                }
+                code[i] = dsp::calib_hr(sum / _frames, _gain[i], _ofs[i]) << (CODE_FRAC - dsp::HR_FRAC);
+            }
+        } else {
+            // de-interleave, sort and sum up center samples
+            uint32_t sum[NUM_CH];
+            trimmed_mean_t::get_sum(block, _frames, sum);
+            for (int i = 0; i < NUM_CH; i++) {
+                code[i] = get_trimmed_mean_code(i, sum[i]);
+            }
+        }
+    }
+
+    /**
+    * calibrated code of the sum by trimmed_mean_t (in ADC code)
+    *
+    * @param[in] ch the channel
+    * @param[in] sum the sum of trimmed_mean_t::num_ave(get_block_frames()) samples
+    * @return the code
+    */
+    inline int32_t get_trimmed_mean_code(const int ch, const uint32_t sum) const
+    {
+        return static_cast<int32_t>((static_cast<int64_t>(sum) * _gain[ch]) >> 16) / _num_ave + _ofs[ch];
+    }
+
+    /**
+    * calibrated code by per-sample ballistics of current mode
+    *
+    * @param[in] block the samples from front_end()
+    * @param[out] code the code of each channel (CODE_FRAC bits)
+    */
+    inline void get_ballistics_code(const uint16_t* block, int32_t code[NUM_CH])
+    {
+        for (int i = 0; i < NUM_CH; i++) {
+            if constexpr (OVERSAMPLE > 1) {
+                (void)block;
+                _ballistics[i].process(&_hr_block[i], NUM_CH, _frames, _gain[i], _ofs[i]);
+            } else {
+                _ballistics[i].process(&block[i], NUM_CH, _frames, _gain[i], _ofs[i]);
+            }
+            code[i] = _ballistics[i].get_value_q(CODE_FRAC);
+        }
+    }
+
+    /**
+    * dB level conversion from calibrated code with frac bits
+    *
+    * @tparam N the number of codes
+    * @param[in] code the codes
+    * @param[in] frac the fractional bits of code
+    * @param[out] level the levels
+    * @param[in] conv the converter of N codes used without lookup table
+    */
+    template <int N>
+    inline void code_to_level(const int32_t code[N], const int frac, unsigned int level[N], conv_dB_level* conv) const
+    {
+        if (_table != nullptr && frac > 0 && _threshold != nullptr) {
+            for (int i = 0; i < N; i++) {
+                level[i] = threshold_level(code[i] << (8 - frac), _threshold, _num_levels);
+            }
+        } else if (_table != nullptr) {
+            for (int i = 0; i < N; i++) {
+                int32_t c = (frac > 0) ? (code[i] + (1 << (frac - 1))) >> frac : code[i];
+                if (c < 0) { c = 0; }
+                if (c > ADC_MAX) { c = ADC_MAX; }
+                level[i] = _table[c];
+            }
+        } else {
+            float norm[N];
+            for (int i = 0; i < N; i++) {
+                norm[i] = static_cast<float>(code[i]) / (1 << frac) / ADC_MAX / _range_ratio;
+                if (norm[i] < 0.0) { norm[i] = 0.0; }
+                if (norm[i] > 1.0) { norm[i] = 1.0; }
+            }
+            conv->get_level(norm, level);
+        }
+    }
+
+    /**
+    * dB level conversion of the code of channels
+    *
+    * @param[in] code the code of each channel (CODE_FRAC bits)
+    * @param[out] level the level of each channel
+    */
+    inline void get_level(const int32_t code[NUM_CH], unsigned int level[NUM_CH]) const
+    {
+        PERF_SCOPE(CONV_DB_LEVEL);
+        code_to_level<NUM_CH>(code, CODE_FRAC, level, _conv);
+    }
+
+    /**
+    * update peak hold by the levels of a block
+    *
+    * @param[in] level the level of each channel
+    * @param[in] seq the sequence number of the block
+    */
+    inline void hold(const unsigned int level[NUM_CH], const uint32_t seq) { _peak_hold.process(level, seq); }
+
+    inline int get_peak_hold(const int ch) const { return _peak_hold.get(ch); }
+
+    /**
+    * process a captured block through all the stages (block processing of level_meter without auto-ranging)
+    *
+    * @param[in] raw the captured samples (get_raw_len())
+    * @param[in] seq the sequence number of the block
+    * @param[in] mode the metering mode
+    * @param[out] code the code of each channel (CODE_FRAC bits)
+    * @param[out] level the level of each channel (peak hold by get_peak_hold())
+    * @param[in] mean true to take the mean code regardless of mode (zero calibration)
+    * @return the samples from front_end() for the other analysis of the block
+    */
+    inline const uint16_t* process(const uint16_t* raw, const uint32_t seq, const meter_mode_t mode, int32_t code[NUM_CH], unsigned int level[NUM_CH], const bool mean = false)
+    {
+        const uint16_t* block = front_end(raw);
+        set_mode(mode);
+        if (mean || mode == meter_mode_t::TRIMMED_MEAN) {
+            get_mean_code(block, code);
+        } else {
+            get_ballistics_code(block, code);
+        }
+        get_level(code, level);
+        hold(level, seq);
+        return block;
+    }
+
+protected:
+    const float _range_ratio;
+    const uint8_t* _table;        // lookup table indexed by calibrated code
+    const uint32_t* _threshold;   // thresholds of the lookup table in Q8 of calibrated code
+    int _num_levels;
+    conv_dB_level* _conv;         // runtime configurable dB scale
+    int _frames;                  // frames per block
+    int _num_ave;                 // samples averaged by trimmed mean
+    uint32_t _rate;               // sampling rate per channel
+    int32_t _gain[NUM_CH];        // Q16
+    int32_t _ofs[NUM_CH];
+    ballistics::coef_t _coef[NUM_MODES];  // for current sampling rate
+    ballistics _ballistics[NUM_CH];
+    peak_hold<NUM_CH> _peak_hold;
+    // oversampling front end (a block is decimated to _frames)
+    //   the level is computed from the high resolution samples, and the others take the samples rounded to ADC code
+    cic_decimator<(OVERSAMPLE > 1) ? OVERSAMPLE : 2> _cic[(OVERSAMPLE > 1) ? NUM_CH : 1];  // unused without oversampling
+    int32_t _hr_block[(OVERSAMPLE > 1) ? BLOCK_LEN : 1];   // decimated samples (Q4 of ADC code)
+    uint16_t _dec_block[(OVERSAMPLE > 1) ? BLOCK_LEN : 1];  // decimated samples rounded to ADC code
+};
+}
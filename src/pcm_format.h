@@ -0,0 +1,75 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* raw PCM stream of captured blocks (payload of wire_frame)
+*
+* payload: seq(u32), num_overruns(u32), sample_rate(u32), num_ch(u8), bits(u8), samples(u16 LE)[]
+*   the samples are the ones in the DMA ring as captured (interleaved in round-robin from the first channel)
+*   sample_rate is the aggregate rate of all channels (ADC rate including oversampling)
+*   num_overruns is the total number of blocks overwritten by DMA before being sent
+*/
+namespace pcm
+{
+    static constexpr uint8_t FRAME_PCM = 'P';
+    static constexpr int PREFIX_LEN = 14;
+
+    typedef struct _prefix_t {
+        uint32_t seq;            // sequence number of the block
+        uint32_t num_overruns;
+        uint32_t sample_rate;
+        uint8_t num_ch;
+        uint8_t bits;            // resolution of samples
+    } prefix_t;
+
+    /**
+    * serialize the prefix of payload
+    *
+    * @param[in] p the prefix
+    * @param[out] out the payload (PREFIX_LEN bytes)
+    */
+    static inline void encode_prefix(const prefix_t& p, uint8_t out[])
+    {
+        const uint32_t v[3] = {p.seq, p.num_overruns, p.sample_rate};
+        for (int k = 0; k < 3; k++) {
+            for (int b = 0; b < 4; b++) {
+                out[k * 4 + b] = static_cast<uint8_t>(v[k] >> (b * 8));
+            }
+        }
+        out[12] = p.num_ch;
+        out[13] = p.bits;
+    }
+
+    /**
+    * deserialize the prefix of payload
+    *
+    * @param[in] in the payload
+    * @param[in] len the size of payload
+    * @param[out] p the prefix
+    * @return false if the payload is invalid
+    */
+    static inline bool decode_prefix(const uint8_t in[], const int len, prefix_t& p)
+    {
+        if (len < PREFIX_LEN) { return false; }
+        uint32_t v[3];
+        for (int k = 0; k < 3; k++) {
+            v[k] = in[k * 4] | (in[k * 4 + 1] << 8) | (in[k * 4 + 2] << 16) | (static_cast<uint32_t>(in[k * 4 + 3]) << 24);
+        }
+        p.seq = v[0];
+        p.num_overruns = v[1];
+        p.sample_rate = v[2];
+        p.num_ch = in[12];
+        p.bits = in[13];
+        return p.num_ch > 0 && (len - PREFIX_LEN) % (p.num_ch * 2) == 0;
+    }
+}
+}
@@ -0,0 +1,77 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* time based peak hold of levels for multi-channel
+*
+* The held level is replaced by a higher level at once, or by the current level
+* after it has been held for the hold time.
+*
+* @tparam NUM_CH the number of channels
+*/
+template <int NUM_CH>
+class peak_hold
+{
+public:
+    /**
+    * constructor of peak_hold
+    */
+    peak_hold() : _hold_blocks(1) { reset(); }
+
+    /**
+    * set the hold time
+    *
+    * @param[in] blocks the hold time in blocks (at least 1)
+    */
+    void set_hold_blocks(const uint32_t blocks) { _hold_blocks = (blocks == 0) ? 1 : blocks; }
+
+    /**
+    * clear the held levels
+    */
+    void reset()
+    {
+        for (int i = 0; i < NUM_CH; i++) {
+            _level[i] = 0;
+            _seq[i] = 0;
+        }
+    }
+
+    /**
+    * update the held levels by the levels of a block
+    *
+    * @param[in] level the level of each channel
+    * @param[in] seq the sequence number of the block
+    */
+    inline void process(const unsigned int level[NUM_CH], const uint32_t seq)
+    {
+        for (int i = 0; i < NUM_CH; i++) {
+            if (_level[i] < static_cast<int>(level[i]) || seq - _seq[i] >= _hold_blocks) {
+                _level[i] = level[i];
+                _seq[i] = seq;
+            }
+        }
+    }
+
+    /**
+    * get the held level
+    *
+    * @param[in] ch the channel
+    * @return the held level
+    */
+    inline int get(const int ch) const { return _level[ch]; }
+
+protected:
+    uint32_t _hold_blocks;
+    uint32_t _seq[NUM_CH];  // sequence number of the block when the level was held
+    int _level[NUM_CH];
+};
+}
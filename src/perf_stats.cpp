@@ -0,0 +1,116 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "perf_stats.h"
+
+#if PICO_LEVEL_METER_PERF
+
+#include <cstdio>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+
+namespace level_meter
+{
+namespace perf_stats
+{
+
+typedef struct _stats_t {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t overruns;
+    uint32_t hist[NUM_BUCKETS];
+    uint32_t deadline;
+    volatile bool resetReq;  // reset is done by the recording side to avoid race
+} stats_t;
+
+static stats_t stats[NUM_STAGES];
+static const char* const STAGE_NAME[NUM_STAGES] = {
+    "process_block",
+    "conv_dB_level",
+    "true_peak",
+    "loudness",
+    "stereo",
+    "spectrum",
+    "decimate",
+    "drawLevelMeter",
+    "lcd_flush",
+    "fm62429::send_code"
+};
+
+static void _reset(stats_t& s)
+{
+    s.count = 0;
+    s.min = UINT32_MAX;
+    s.max = 0;
+    s.sum = 0;
+    s.overruns = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        s.hist[i] = 0;
+    }
+}
+
+void init()
+{
+    // DWT is per core, so this needs to be called on each core
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+    for (int i = 0; i < NUM_STAGES; i++) {
+        stats[i].resetReq = true;
+    }
+}
+
+void set_deadline(const stage_t stage, const uint32_t cycles)
+{
+    stats[stage].deadline = cycles;
+}
+
+void __time_critical_func(record)(const stage_t stage, const uint32_t cycles)
+{
+    stats_t& s = stats[stage];
+    if (s.resetReq) {
+        _reset(s);
+        s.resetReq = false;
+    }
+    s.count++;
+    s.sum += cycles;
+    if (cycles < s.min) { s.min = cycles; }
+    if (cycles > s.max) { s.max = cycles; }
+    if (s.deadline > 0 && cycles > s.deadline) { s.overruns++; }
+    s.hist[31 - __builtin_clz(cycles | 1)]++;
+}
+
+void dump_and_reset()
+{
+    printf("[Performance stats] (cycles at %d MHz)\r\n", static_cast<int>(clock_get_hz(clk_sys) / 1000000));
+    for (int i = 0; i < NUM_STAGES; i++) {
+        const stats_t& s = stats[i];
+        if (s.resetReq || s.count == 0) {
+            printf(" %s: no record\r\n", STAGE_NAME[i]);
+            continue;
+        }
+        printf(" %s: count %d, min %d, ave %d, max %d", STAGE_NAME[i], static_cast<int>(s.count),
+            static_cast<int>(s.min), static_cast<int>(s.sum / s.count), static_cast<int>(s.max));
+        if (s.deadline > 0) {
+            printf(", overruns %d (deadline %d)", static_cast<int>(s.overruns), static_cast<int>(s.deadline));
+        }
+        printf("\r\n ");
+        for (int j = 0; j < NUM_BUCKETS; j++) {
+            if (s.hist[j] > 0) {
+                printf(" [2^%d]:%d", j, static_cast<int>(s.hist[j]));
+            }
+        }
+        printf("\r\n");
+        stats[i].resetReq = true;
+    }
+}
+
+}
+}
+
+#endif // PICO_LEVEL_METER_PERF
@@ -0,0 +1,100 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+// 1: enable cycle instrumentation of hot paths (0: compiled out)
+#ifndef PICO_LEVEL_METER_PERF
+#define PICO_LEVEL_METER_PERF 0
+#endif
+
+#include <cstdint>
+
+#if PICO_LEVEL_METER_PERF
+#include "hardware/structs/m33.h"
+#endif
+
+namespace level_meter
+{
+/**
+* cycle statistics of hot paths measured by DWT cycle counter of Cortex-M33
+*/
+namespace perf_stats
+{
+    enum stage_t {
+        PROCESS_BLOCK = 0,  // block processing in DMA IRQ
+        CONV_DB_LEVEL,      // dB level conversion in block processing
+        TRUE_PEAK,          // true-peak detection in block processing
+        LOUDNESS,           // loudness measurement in block processing
+        STEREO,             // stereo analysis in block processing
+        SPECTRUM,           // FFT and band folding of spectrum frame
+        DECIMATE,           // CIC decimation of oversampling front end in block processing
+        DRAW_LEVEL_METER,   // drawLevelMeter (or drawSpectrum) in main loop
+        LCD_FLUSH,          // lcd_renderer::flush (rendering of changed rectangles)
+        FM62429_SEND,       // fm62429::send_code
+        NUM_STAGES
+    };
+    static constexpr int NUM_BUCKETS = 32;  // histogram bucket n counts cycles in [2^n, 2^(n+1))
+
+#if PICO_LEVEL_METER_PERF
+    /**
+    * enable cycle counter of the calling core
+    */
+    void init();
+
+    /**
+    * set the deadline of the stage (exceeding it is counted as overrun)
+    *
+    * @param[in] stage the stage
+    * @param[in] cycles the deadline in cycles (0: no deadline)
+    */
+    void set_deadline(const stage_t stage, const uint32_t cycles);
+
+    /**
+    * record elapsed cycles of the stage
+    *
+    * @param[in] stage the stage
+    * @param[in] cycles the elapsed cycles
+    */
+    void record(const stage_t stage, const uint32_t cycles);
+
+    /**
+    * print statistics of all the stages and reset them
+    */
+    void dump_and_reset();
+
+    /**
+    * get current cycle count
+    *
+    * @return cycle count of the calling core
+    */
+    static inline uint32_t now() { return m33_hw->dwt_cyccnt; }
+
+    /**
+    * measure cycles from construction to destruction
+    */
+    class scope
+    {
+    public:
+        scope(const stage_t stage) : _stage(stage), _t0(now()) {}
+        ~scope() { record(_stage, now() - _t0); }
+    private:
+        const stage_t _stage;
+        const uint32_t _t0;
+    };
+#else
+    static inline void init() {}
+    static inline void set_deadline(const stage_t, const uint32_t) {}
+    static inline void dump_and_reset() {}
+#endif
+}
+}
+
+#if PICO_LEVEL_METER_PERF
+#define PERF_SCOPE(stage) level_meter::perf_stats::scope __perf_scope_##stage(level_meter::perf_stats::stage)
+#else
+#define PERF_SCOPE(stage)
+#endif
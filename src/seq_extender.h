@@ -0,0 +1,121 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* extension of the block sequence number known only modulo TABLE_LEN to 32 bits
+*
+* The DMA block address table tells the block being written modulo TABLE_LEN.
+* The blocks elapsed since the last anchor are estimated by a free-running microsecond
+* timer, and the table index picks the exact block nearest to the estimate. The estimate
+* must be within TABLE_LEN / 2 blocks, which holds for outages up to minutes with the
+* accuracy of ADC clock divider, and up to 71 minutes (wrap of 32-bit microseconds).
+*
+* The anchor is written by one context (DMA IRQ) and read from any context.
+*
+* @tparam TABLE_LEN the modulo of the table index (power of 2)
+*/
+template <int TABLE_LEN>
+class seq_extender
+{
+    static_assert((TABLE_LEN & (TABLE_LEN - 1)) == 0, "TABLE_LEN must be power of 2");
+
+public:
+    /**
+    * set the block period
+    *
+    * @param[in] block_len samples in a block
+    * @param[in] sample_rate samples per second
+    */
+    void set_rate(const uint32_t block_len, const uint32_t sample_rate)
+    {
+        _block_len.store(block_len);
+        _sample_rate.store(sample_rate);
+    }
+
+    /**
+    * anchor at start of capture
+    *
+    * @param[in] seq the sequence number of the block being written
+    * @param[in] now_us the time in microseconds
+    */
+    void start(const uint32_t seq, const uint32_t now_us) { _anchor(seq, now_us, true); }
+
+    /**
+    * anchor at stop of capture (the sequence number is held until start())
+    *
+    * @param[in] idx the sequence number of the block being written modulo TABLE_LEN
+    * @param[in] now_us the time in microseconds
+    */
+    void stop(const uint32_t idx, const uint32_t now_us) { _anchor(get(idx, now_us), now_us, false); }
+
+    /**
+    * extend the sequence number and anchor it (writer context only)
+    *
+    * @param[in] idx the sequence number of the block being written modulo TABLE_LEN
+    * @param[in] now_us the time in microseconds
+    * @return the sequence number of the block being written
+    */
+    uint32_t update(const uint32_t idx, const uint32_t now_us)
+    {
+        const uint32_t seq = get(idx, now_us);
+        _anchor(seq, now_us, true);
+        return seq;
+    }
+
+    /**
+    * extend the sequence number (any context)
+    *
+    * @param[in] idx the sequence number of the block being written modulo TABLE_LEN
+    * @param[in] now_us the time in microseconds
+    * @return the sequence number of the block being written
+    */
+    uint32_t get(const uint32_t idx, const uint32_t now_us) const
+    {
+        uint32_t ver, seq, us;
+        bool running;
+        do {
+            ver = _ver.load(std::memory_order_acquire);
+            seq = _seq.load(std::memory_order_relaxed);
+            us = _us.load(std::memory_order_relaxed);
+            running = _running.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while ((ver & 1) != 0 || ver != _ver.load(std::memory_order_relaxed));
+        uint32_t est = seq;
+        if (running) {
+            const uint64_t den = static_cast<uint64_t>(_block_len.load(std::memory_order_relaxed)) * 1000000;
+            est += static_cast<uint32_t>(static_cast<uint64_t>(now_us - us) * _sample_rate.load(std::memory_order_relaxed) / den);
+        }
+        // the block congruent to idx nearest to the estimate
+        const int32_t d = static_cast<int32_t>((idx - est + TABLE_LEN / 2) & (TABLE_LEN - 1)) - TABLE_LEN / 2;
+        return est + d;
+    }
+
+private:
+    std::atomic<uint32_t> _ver{0};  // odd while the anchor is being written
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint32_t> _us{0};
+    std::atomic<bool> _running{false};
+    std::atomic<uint32_t> _block_len{1};
+    std::atomic<uint32_t> _sample_rate{1};
+
+    void _anchor(const uint32_t seq, const uint32_t now_us, const bool running)
+    {
+        _ver.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _seq.store(seq, std::memory_order_relaxed);
+        _us.store(now_us, std::memory_order_relaxed);
+        _running.store(running, std::memory_order_relaxed);
+        _ver.fetch_add(1, std::memory_order_release);
+    }
+};
+}
@@ -0,0 +1,54 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "spectrum.h"
+
+#include <cmath>
+
+namespace level_meter
+{
+
+spectrum::spectrum(const int num_ch) :
+    _num_ch(num_ch), _interval(FFT_SIZE), _count(0), _num_skipped(0), _pos(0), _busy(false)
+{
+    constexpr double PI = 3.14159265358979323846;
+    for (int k = 0; k < FFT_SIZE; k++) {
+        _hist[k] = 0;
+        _window[k] = static_cast<int16_t>(lround((0.5 - 0.5 * cos(2.0 * PI * k / FFT_SIZE)) * 32767.0));
+    }
+    // log-spaced bands from bin 1 to Nyquist (at least 1 bin for each band)
+    constexpr int NUM_BINS = FFT_SIZE / 2;
+    for (int b = 0; b <= NUM_BANDS; b++) {
+        int e = static_cast<int>(lround(pow(static_cast<double>(NUM_BINS), static_cast<double>(b) / NUM_BANDS)));
+        if (b > 0 && e <= _edge[b - 1]) { e = _edge[b - 1] + 1; }
+        _edge[b] = e;
+    }
+    _edge[NUM_BANDS] = NUM_BINS;
+}
+
+void spectrum::set_interval(const uint32_t interval)
+{
+    _interval = (interval == 0) ? 1 : interval;
+    _count = 0;
+}
+
+void spectrum::compute(int32_t amp[NUM_BANDS])
+{
+    _fft.forward(_work);
+    // a sine of amplitude A reads 2A (Hann coherent gain 1/2, FFT scale 1/N, Q15 << SHIFT)
+    constexpr float SCALE = 1.0f / (1 << (SHIFT - 2));
+    for (int b = 0; b < NUM_BANDS; b++) {
+        uint32_t max = 0;
+        for (int k = _edge[b]; k < _edge[b + 1]; k++) {
+            const uint32_t p = static_cast<uint32_t>(dsp::smuad(_work[k], _work[k]));
+            if (p > max) { max = p; }
+        }
+        amp[b] = static_cast<int32_t>(sqrtf(static_cast<float>(max)) * SCALE);
+    }
+    _busy.store(false, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,125 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "dsp_util.h"
+#include "fft.h"
+
+namespace level_meter
+{
+/**
+* class for spectrum analysis of the mono mix of interleaved channels
+*
+* push() keeps the latest FFT_SIZE samples in the history and captures a windowed frame
+* into the work buffer at every frame interval (double buffering). compute() runs FFT
+* on the work buffer in another context and folds the bins into log-spaced bands.
+* A frame is skipped if compute() of the previous frame has not finished.
+* The calibrated code is clamped at zero, so that a full-wave rectified input shows
+* the components of the rectified signal (2f and its harmonics for a sine of f).
+*
+* Memory: history 2 * FFT_SIZE, window 2 * FFT_SIZE, work 4 * FFT_SIZE
+*         and FFT tables 5 * FFT_SIZE bytes (6.5 KB in total for FFT_SIZE = 256)
+*/
+class spectrum
+{
+public:
+    static constexpr int FFT_SIZE = 256;
+    static constexpr int NUM_BANDS = 16;
+    static constexpr int SHIFT = 3;  // calibrated code (12bit) to Q15 sample
+
+    /**
+    * constructor of spectrum
+    *
+    * @param[in] num_ch the number of interleaved channels
+    */
+    spectrum(const int num_ch);
+
+    /**
+    * set the frame interval
+    *
+    * @param[in] interval the frame interval in samples per channel
+    */
+    void set_interval(const uint32_t interval);
+
+    /**
+    * push interleaved samples (capture side)
+    *
+    * @param[in] block the interleaved samples
+    * @param[in] len the number of samples per channel
+    * @param[in] gain the calibration gain of each channel (Q16)
+    * @param[in] ofs the calibration offset of each channel in ADC code
+    * @return true if a frame has been captured to be computed
+    */
+    inline bool push(const uint16_t* block, const int len, const int32_t gain[], const int32_t ofs[])
+    {
+        bool flag = false;
+        for (int j = 0; j < len; j++) {
+            int32_t sum = 0;
+            for (int i = 0; i < _num_ch; i++) {
+                sum += dsp::calib(block[j * _num_ch + i], gain[i], ofs[i]);
+            }
+            _hist[_pos] = static_cast<int16_t>(sum / _num_ch);
+            _pos = (_pos + 1) & (FFT_SIZE - 1);
+            if (++_count >= _interval) {
+                _count = 0;
+                if (_busy.load(std::memory_order_acquire)) {
+                    _num_skipped++;
+                } else {
+                    _capture();
+                    flag = true;
+                }
+            }
+        }
+        return flag;
+    }
+
+    /**
+    * compute FFT of the captured frame and release the work buffer
+    *
+    * @param[out] amp the peak amplitude of each band in calibrated ADC code
+    */
+    void compute(int32_t amp[NUM_BANDS]);
+
+    /**
+    * get the number of skipped frames
+    *
+    * @return the number of skipped frames
+    */
+    uint32_t get_num_skipped() const { return _num_skipped; }
+
+protected:
+    int _num_ch;
+    uint32_t _interval;
+    uint32_t _count;
+    uint32_t _num_skipped;
+    int16_t _hist[FFT_SIZE];    // latest samples in ring (calibrated code)
+    int _pos;                   // the oldest sample in _hist
+    int16_t _window[FFT_SIZE];  // Hann (Q15)
+    uint32_t _work[FFT_SIZE];   // packed complex for FFT
+    std::atomic<bool> _busy;
+    int _edge[NUM_BANDS + 1];   // first bin of each band
+    fft_radix4<FFT_SIZE> _fft;
+
+    inline void _capture()
+    {
+        // remove DC and apply window from the oldest sample
+        int32_t sum = 0;
+        for (int k = 0; k < FFT_SIZE; k++) {
+            sum += _hist[k];
+        }
+        const int32_t mean = sum / FFT_SIZE;
+        for (int k = 0; k < FFT_SIZE; k++) {
+            const int32_t x = (_hist[(_pos + k) & (FFT_SIZE - 1)] - mean) << SHIFT;
+            _work[k] = dsp::pack((x * _window[k]) >> 15, 0);
+        }
+        _busy.store(true, std::memory_order_release);
+    }
+};
+}
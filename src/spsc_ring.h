@@ -0,0 +1,148 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* policy when pushing to the full ring
+*/
+enum class overflow_policy_t {
+    DROP_NEWEST,  // keep the items in the ring and discard the pushed one
+    DROP_OLDEST   // discard the oldest item in the ring to keep the latest one
+};
+
+/**
+* lock-free single-producer / single-consumer ring buffer
+* (producer and consumer can be on different cores or in IRQ and thread context)
+*
+* push() never waits. With DROP_OLDEST, pop() retries only when the producer
+* has just discarded the item being read.
+*
+* @tparam T the type of item (trivially copyable)
+* @tparam N the number of items (power of 2)
+*/
+template <typename T, uint32_t N>
+class spsc_ring
+{
+public:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be power of 2");
+
+    /**
+    * constructor of spsc_ring
+    *
+    * @param[in] policy the policy when pushing to the full ring
+    */
+    spsc_ring(const overflow_policy_t policy = overflow_policy_t::DROP_OLDEST) : _policy(policy) {}
+
+    /**
+    * set the policy when pushing to the full ring
+    *
+    * @param[in] policy the policy when pushing to the full ring
+    */
+    void set_policy(const overflow_policy_t policy) { _policy = policy; }
+
+    /**
+    * push an item (producer side)
+    *
+    * @param[in] item the item to push
+    * @return false if an item has been dropped
+    */
+    bool push(const T& item)
+    {
+        const uint32_t wr = _wr.load(std::memory_order_relaxed);
+        uint32_t rd = _rd.load(std::memory_order_acquire);
+        bool flag = true;
+        while (wr - rd >= N) {
+            if (_policy == overflow_policy_t::DROP_NEWEST) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // discard the oldest (fails if consumer has just popped it, then there is a room)
+            if (_rd.compare_exchange_weak(rd, rd + 1, std::memory_order_acq_rel)) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                flag = false;
+                break;
+            }
+        }
+        _buf[wr & (N - 1)] = item;
+        _wr.store(wr + 1, std::memory_order_release);
+        return flag;
+    }
+
+    /**
+    * get the slot to write an item in place (producer side, DROP_NEWEST only)
+    *
+    * @return the pointer to the slot (pushed by commit()), nullptr if the ring is full (counted as dropped)
+    */
+    T* claim()
+    {
+        const uint32_t wr = _wr.load(std::memory_order_relaxed);
+        if (wr - _rd.load(std::memory_order_acquire) >= N) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &_buf[wr & (N - 1)];
+    }
+
+    /**
+    * push the item written to the slot of claim() (producer side)
+    */
+    void commit()
+    {
+        _wr.store(_wr.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+    * pop an item (consumer side)
+    *
+    * @param[out] item the popped item
+    * @return false if the ring is empty
+    */
+    bool pop(T& item)
+    {
+        uint32_t rd = _rd.load(std::memory_order_acquire);
+        while (true) {
+            const uint32_t wr = _wr.load(std::memory_order_acquire);
+            if (wr == rd) { return false; }
+            item = _buf[rd & (N - 1)];
+            // the item is valid only if the producer has not discarded it meanwhile
+            if (_rd.compare_exchange_weak(rd, rd + 1, std::memory_order_acq_rel)) { return true; }
+        }
+    }
+
+    /**
+    * get the number of items in the ring
+    *
+    * @return the number of items
+    */
+    uint32_t size() const
+    {
+        return _wr.load(std::memory_order_acquire) - _rd.load(std::memory_order_acquire);
+    }
+
+    /**
+    * get the total number of dropped items
+    *
+    * @return the number of dropped items
+    */
+    uint32_t dropped() const
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    T _buf[N];
+    std::atomic<uint32_t> _wr{0};
+    std::atomic<uint32_t> _rd{0};
+    std::atomic<uint32_t> _dropped{0};
+    overflow_policy_t _policy;
+};
+}
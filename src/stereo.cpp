@@ -0,0 +1,74 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "stereo.h"
+
+#include <cmath>
+
+namespace level_meter
+{
+
+stereo::stereo(const int num_ch, const int32_t full_scale) :
+    _num_ch(num_ch), _full_scale_sq(static_cast<float>(full_scale) * full_scale), _step(1)
+{
+    reset();
+}
+
+void stereo::set_sample_rate(const uint32_t sample_rate)
+{
+    _step = sample_rate * SUB_BLOCK_MS / 1000;
+    if (_step == 0) { _step = 1; }
+    reset();
+}
+
+void stereo::reset()
+{
+    _count = 0;
+    _acc_pw = _acc_df = _acc_cr = 0;
+    _ll = _rr = _lr = 0;
+    _n = 0;
+    _correlation.store(0.0f, std::memory_order_relaxed);
+    _balance.store(0.0f, std::memory_order_relaxed);
+    _mid.store(LEVEL_FLOOR, std::memory_order_relaxed);
+    _side.store(LEVEL_FLOOR, std::memory_order_relaxed);
+}
+
+void stereo::_close_sub_block()
+{
+    // leaky integration of the moments (steady state is 2^DECAY_SHIFT sub blocks)
+    _ll += (_acc_pw + _acc_df) / 2 - (_ll >> DECAY_SHIFT);
+    _rr += (_acc_pw - _acc_df) / 2 - (_rr >> DECAY_SHIFT);
+    _lr += _acc_cr / 2 - (_lr >> DECAY_SHIFT);
+    _n += _count - (_n >> DECAY_SHIFT);
+    _acc_pw = _acc_df = _acc_cr = 0;
+    _count = 0;
+
+    // signal below 1 LSB rms is regarded as silence
+    const float ll = static_cast<float>(_ll);
+    const float rr = static_cast<float>(_rr);
+    const float lr = static_cast<float>(_lr);
+    const float n = static_cast<float>(_n);
+    const bool hasL = ll > n;
+    const bool hasR = rr > n;
+    _correlation.store((hasL && hasR) ? lr / sqrtf(ll * rr) : 0.0f, std::memory_order_relaxed);
+    _balance.store((hasL || hasR) ? 10.0f * log10f(fmaxf(ll, n) / fmaxf(rr, n)) : 0.0f, std::memory_order_relaxed);
+    auto level = [&](const float e) {
+        // mean square of (L +/- R) / 2 relative to full scale
+        return (e > n * 4.0f) ? 10.0f * log10f(e / 4.0f / n / _full_scale_sq) : LEVEL_FLOOR;
+    };
+    _mid.store(level(ll + rr + 2.0f * lr), std::memory_order_relaxed);
+    _side.store(level(ll + rr - 2.0f * lr), std::memory_order_relaxed);
+}
+
+void stereo::get(stereo_t& st) const
+{
+    st.correlation = _correlation.load(std::memory_order_relaxed);
+    st.balance = _balance.load(std::memory_order_relaxed);
+    st.mid = _mid.load(std::memory_order_relaxed);
+    st.side = _side.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,125 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "dsp_util.h"
+
+namespace level_meter
+{
+/**
+* stereo analysis values
+*/
+typedef struct _stereo_t {
+    float correlation;  // phase correlation (-1.0 ~ +1.0, 0.0 without signal)
+    float balance;      // L/R balance in dB (positive: L is louder)
+    float mid;          // level of mid (L + R) / 2 in dB of full scale
+    float side;         // level of side (L - R) / 2 in dB of full scale
+} stereo_t;
+
+/**
+* class for stereo correlation, balance and mid/side levels of the first 2 channels (interleaved multi-channel)
+*
+* A frame of calibrated L and R is packed into dual 16-bit, and the moments L^2 + R^2, L^2 - R^2 and 2LR
+* are accumulated in one pass by 3 dual MACs (SMLAD, SMLSD and SMLADX). The moments of every sub block
+* are integrated with the time constant of 2^DECAY_SHIFT sub blocks, and the values are updated at the end
+* of each sub block. The values are taken about the zero level of the calibrated code.
+*/
+class stereo
+{
+public:
+    static constexpr uint32_t SUB_BLOCK_MS = 40;
+    static constexpr int DECAY_SHIFT = 3;  // time constant of 320 ms
+    static constexpr int CHUNK = 16;       // frames accumulated in 32 bit (16 * 2 * 4095^2 < 2^31)
+    static constexpr float LEVEL_FLOOR = -99.9f;
+
+    /**
+    * constructor of stereo
+    *
+    * @param[in] num_ch the number of interleaved channels (at least 2, L and R are the first 2 channels)
+    * @param[in] full_scale the calibrated code of full scale
+    */
+    stereo(const int num_ch, const int32_t full_scale);
+
+    /**
+    * set the sampling rate per channel and reset
+    *
+    * @param[in] sample_rate the sampling rate in Hz
+    */
+    void set_sample_rate(const uint32_t sample_rate);
+
+    /**
+    * reset the measurement
+    */
+    void reset();
+
+    /**
+    * process interleaved samples
+    *
+    * @param[in] block the interleaved samples
+    * @param[in] len the number of samples per channel
+    * @param[in] gain the calibration gain of each channel (Q16)
+    * @param[in] ofs the calibration offset of each channel in ADC code
+    */
+    inline void process(const uint16_t* block, const int len, const int32_t gain[], const int32_t ofs[])
+    {
+        int j = 0;
+        while (j < len) {
+            // up to the end of sub block in chunks
+            int n = len - j;
+            if (n > CHUNK) { n = CHUNK; }
+            if (n > static_cast<int>(_step - _count)) { n = static_cast<int>(_step - _count); }
+            int32_t pw = 0;  // L^2 + R^2
+            int32_t df = 0;  // L^2 - R^2
+            int32_t cr = 0;  // 2LR
+            for (int k = j; k < j + n; k++) {
+                const uint16_t* f = &block[k * _num_ch];
+                const uint32_t x = dsp::pack(dsp::calib(f[0], gain[0], ofs[0]), dsp::calib(f[1], gain[1], ofs[1]));
+                pw = dsp::smlad(x, x, pw);
+                df = dsp::smlsd(x, x, df);
+                cr = dsp::smladx(x, x, cr);
+            }
+            _acc_pw += pw;
+            _acc_df += df;
+            _acc_cr += cr;
+            j += n;
+            _count += n;
+            if (_count >= _step) {
+                _close_sub_block();
+            }
+        }
+    }
+
+    /**
+    * get stereo analysis values
+    *
+    * @param[out] st the correlation, balance and mid/side levels
+    */
+    void get(stereo_t& st) const;
+
+protected:
+    int _num_ch;
+    float _full_scale_sq;
+    uint32_t _step;   // samples per channel in a sub block
+    uint32_t _count;  // samples per channel in the current sub block
+    int64_t _acc_pw;  // moments of the current sub block
+    int64_t _acc_df;
+    int64_t _acc_cr;
+    int64_t _ll;      // integrated moments
+    int64_t _rr;
+    int64_t _lr;
+    int64_t _n;       // integrated number of frames
+    std::atomic<float> _correlation;
+    std::atomic<float> _balance;
+    std::atomic<float> _mid;
+    std::atomic<float> _side;
+
+    void _close_sub_block();
+};
+}
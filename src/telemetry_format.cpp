@@ -0,0 +1,121 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "telemetry_format.h"
+
+namespace level_meter
+{
+namespace telemetry
+{
+
+static inline uint32_t _zigzag(const int32_t v)
+{
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+static inline int32_t _unzigzag(const uint32_t v)
+{
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+static inline int _put_varint(uint8_t* p, uint32_t v)
+{
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = static_cast<uint8_t>(v);
+    return n;
+}
+
+static inline bool _get_varint(const uint8_t* p, const int len, int& pos, uint32_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) { return false; }
+        const uint8_t c = p[pos++];
+        v |= static_cast<uint32_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) { return true; }
+    }
+    return false;
+}
+
+encoder::encoder(uint8_t out[], const int size, const int num_ch, const uint32_t num_dropped)
+    : _out(out), _size(size), _num_ch(num_ch), _len(0), _num_items(0), _prev()
+{
+    _out[_len++] = static_cast<uint8_t>(num_ch);
+    _len += _put_varint(&_out[_len], num_dropped);
+}
+
+bool encoder::add(const item_t& item)
+{
+    if (_num_items >= MAX_ITEMS) { return false; }
+    uint8_t buf[item_size(MAX_CH)];
+    int n = 0;
+    if (_num_items == 0) {
+        n += _put_varint(&buf[n], item.id);
+        for (int i = 0; i < _num_ch; i++) {
+            n += _put_varint(&buf[n], _zigzag(item.code[i]));
+            buf[n++] = item.level[i];
+            buf[n++] = item.peak_hold[i];
+        }
+    } else {
+        n += _put_varint(&buf[n], item.id - _prev.id);
+        for (int i = 0; i < _num_ch; i++) {
+            n += _put_varint(&buf[n], _zigzag(item.code[i] - _prev.code[i]));
+            n += _put_varint(&buf[n], _zigzag(item.level[i] - _prev.level[i]));
+            n += _put_varint(&buf[n], _zigzag(item.peak_hold[i] - _prev.peak_hold[i]));
+        }
+    }
+    if (_len + n > _size) { return false; }
+    for (int k = 0; k < n; k++) {
+        _out[_len++] = buf[k];
+    }
+    _prev = item;
+    _num_items++;
+    return true;
+}
+
+bool decode(const uint8_t in[], const int len, int& num_ch, uint32_t& num_dropped, item_t items[], int& num_items)
+{
+    int pos = 0;
+    num_items = 0;
+    if (len < 1) { return false; }
+    num_ch = in[pos++];
+    if (num_ch < 1 || num_ch > MAX_CH) { return false; }
+    if (!_get_varint(in, len, pos, num_dropped)) { return false; }
+    while (pos < len) {
+        if (num_items >= MAX_ITEMS) { return false; }
+        item_t& item = items[num_items];
+        uint32_t v;
+        if (!_get_varint(in, len, pos, v)) { return false; }
+        if (num_items == 0) {
+            item.id = v;
+            for (int i = 0; i < num_ch; i++) {
+                if (!_get_varint(in, len, pos, v) || pos + 2 > len) { return false; }
+                item.code[i] = _unzigzag(v);
+                item.level[i] = in[pos++];
+                item.peak_hold[i] = in[pos++];
+            }
+        } else {
+            const item_t& prev = items[num_items - 1];
+            item.id = prev.id + v;
+            for (int i = 0; i < num_ch; i++) {
+                uint32_t dc, dl, dp;
+                if (!_get_varint(in, len, pos, dc) || !_get_varint(in, len, pos, dl) || !_get_varint(in, len, pos, dp)) { return false; }
+                item.code[i] = prev.code[i] + _unzigzag(dc);
+                item.level[i] = static_cast<uint8_t>(prev.level[i] + _unzigzag(dl));
+                item.peak_hold[i] = static_cast<uint8_t>(prev.peak_hold[i] + _unzigzag(dp));
+            }
+        }
+        num_items++;
+    }
+    return num_items > 0;
+}
+
+}
+}
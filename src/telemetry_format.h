@@ -0,0 +1,106 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* binary telemetry of level items (payload of wire_frame)
+*
+* payload: num_ch, num_dropped(varint), item[]
+*   the first item of a frame is absolute: id(varint), then code(zigzag varint), level and peak hold (u8) of each channel
+*   the following items are delta from the previous one: id(varint), then code, level and peak hold (zigzag varint) of each channel
+* Each frame is decoded by itself, so that a lost frame does not break the following ones.
+* num_dropped is the total number of items dropped by the device before being sent.
+*/
+namespace telemetry
+{
+    static constexpr uint8_t FRAME_LEVEL = 'L';
+    static constexpr int MAX_CH = 4;
+    static constexpr int MAX_ITEMS = 16;  // items per frame
+
+    typedef struct _item_t {
+        uint32_t id;             // sequence number of the block
+        int32_t code[MAX_CH];    // calibrated code (Q8 with oversampling or auto-ranging)
+        uint8_t level[MAX_CH];
+        uint8_t peak_hold[MAX_CH];
+    } item_t;
+
+    /**
+    * get the max size of an item
+    *
+    * @param[in] num_ch the number of channels
+    * @return the size in bytes
+    */
+    static constexpr int item_size(const int num_ch)
+    {
+        return 5 + num_ch * (5 + 5 + 5);
+    }
+
+    /**
+    * get the max payload size of frame
+    *
+    * @param[in] num_ch the number of channels
+    * @return the size in bytes
+    */
+    static constexpr int payload_size(const int num_ch)
+    {
+        return 1 + 5 + MAX_ITEMS * item_size(num_ch);
+    }
+
+    /**
+    * serializer of items into a payload
+    */
+    class encoder
+    {
+    public:
+        /**
+        * constructor of encoder
+        *
+        * @param[out] out the payload
+        * @param[in] size the capacity of out
+        * @param[in] num_ch the number of channels
+        * @param[in] num_dropped the total number of dropped items
+        */
+        encoder(uint8_t out[], const int size, const int num_ch, const uint32_t num_dropped);
+
+        /**
+        * append an item
+        *
+        * @param[in] item the item
+        * @return false if the item does not fit in the payload or the frame is full (not appended)
+        */
+        bool add(const item_t& item);
+
+        int len() const { return _len; }
+        int num_items() const { return _num_items; }
+
+    protected:
+        uint8_t* _out;
+        int _size;
+        int _num_ch;
+        int _len;
+        int _num_items;
+        item_t _prev;
+    };
+
+    /**
+    * deserialize frame
+    *
+    * @param[in] in the payload
+    * @param[in] len the size of payload
+    * @param[out] num_ch the number of channels
+    * @param[out] num_dropped the total number of dropped items
+    * @param[out] items the items (MAX_ITEMS)
+    * @param[out] num_items the number of items
+    * @return false if the payload is invalid
+    */
+    bool decode(const uint8_t in[], const int len, int& num_ch, uint32_t& num_dropped, item_t items[], int& num_items);
+}
+}
@@ -0,0 +1,173 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "trace_format.h"
+
+namespace level_meter
+{
+namespace trace
+{
+
+// little endian serialization
+class writer
+{
+public:
+    writer(uint8_t* p) : _p(p), _pos(0) {}
+    void u8(const uint8_t v) { _p[_pos++] = v; }
+    void u16(const uint16_t v) { u8(v & 0xff); u8(v >> 8); }
+    void u32(const uint32_t v) { u16(v & 0xffff); u16(v >> 16); }
+    int pos() const { return _pos; }
+protected:
+    uint8_t* _p;
+    int _pos;
+};
+
+class reader
+{
+public:
+    reader(const uint8_t* p, const int len) : _p(p), _len(len), _pos(0) {}
+    bool ok(const int n) const { return _pos + n <= _len; }
+    uint8_t u8() { return _p[_pos++]; }
+    uint16_t u16() { const uint16_t v = u8(); return v | (u8() << 8); }
+    uint32_t u32() { const uint32_t v = u16(); return v | (static_cast<uint32_t>(u16()) << 16); }
+    int pos() const { return _pos; }
+protected:
+    const uint8_t* _p;
+    int _len;
+    int _pos;
+};
+
+int encode_header(const header_t& h, uint8_t out[])
+{
+    writer w(out);
+    w.u32(h.version);
+    w.u32(h.seq);
+    w.u32(h.sample_rate);
+    w.u8(h.num_ch);
+    w.u8(h.block_frames);
+    w.u8(h.oversample);
+    w.u8(h.calibrating);
+    w.u16(h.calib_count);
+    w.u8(h.num_modes);
+    w.u8(h.num_ranges);
+    w.u8(h.num_levels);
+    w.u8(h.range_num_levels);
+    for (int i = 0; i < h.num_ch; i++) {
+        w.u32(h.zero[i]);
+        w.u32(h.zero_ref[i]);
+    }
+    for (int i = 0; i < h.num_modes; i++) {
+        w.u32(h.k_att[i]);
+        w.u32(h.k_rel[i]);
+    }
+    for (int i = 0; i < h.num_ranges; i++) {
+        w.u32(h.range_gain[i]);
+    }
+    for (int i = 0; i < h.num_levels; i++) {
+        w.u32(h.threshold[i]);
+    }
+    for (int i = 0; i < h.range_num_levels; i++) {
+        w.u32(h.range_threshold[i]);
+    }
+    return w.pos();
+}
+
+bool decode_header(const uint8_t in[], const int len, header_t& h)
+{
+    reader r(in, len);
+    if (!r.ok(22)) { return false; }
+    h.version = r.u32();
+    h.seq = r.u32();
+    h.sample_rate = r.u32();
+    h.num_ch = r.u8();
+    h.block_frames = r.u8();
+    h.oversample = r.u8();
+    h.calibrating = r.u8();
+    h.calib_count = r.u16();
+    h.num_modes = r.u8();
+    h.num_ranges = r.u8();
+    h.num_levels = r.u8();
+    h.range_num_levels = r.u8();
+    if (h.version != VERSION || h.num_ch > MAX_CH || h.num_modes > MAX_MODES || h.num_ranges > MAX_RANGES ||
+        h.num_levels > MAX_LEVELS || h.range_num_levels > MAX_LEVELS) { return false; }
+    if (!r.ok((h.num_ch + h.num_modes) * 8 + (h.num_ranges + h.num_levels + h.range_num_levels) * 4)) { return false; }
+    for (int i = 0; i < h.num_ch; i++) {
+        h.zero[i] = static_cast<int32_t>(r.u32());
+        h.zero_ref[i] = static_cast<int32_t>(r.u32());
+    }
+    for (int i = 0; i < h.num_modes; i++) {
+        h.k_att[i] = static_cast<int32_t>(r.u32());
+        h.k_rel[i] = static_cast<int32_t>(r.u32());
+    }
+    for (int i = 0; i < h.num_ranges; i++) {
+        h.range_gain[i] = static_cast<int32_t>(r.u32());
+    }
+    for (int i = 0; i < h.num_levels; i++) {
+        h.threshold[i] = r.u32();
+    }
+    for (int i = 0; i < h.range_num_levels; i++) {
+        h.range_threshold[i] = r.u32();
+    }
+    return true;
+}
+
+int encode_block(const block_t& b, const int num_ch, const uint16_t raw[], const int raw_len, uint8_t out[])
+{
+    writer w(out);
+    w.u32(b.seq);
+    w.u8(b.flags);
+    w.u8(b.mode);
+    w.u32(b.switch_pos);
+    w.u16(static_cast<uint16_t>(raw_len));
+    for (int i = 0; i < num_ch; i++) {
+        w.u32(static_cast<uint32_t>(b.code[i]));
+        w.u8(b.level[i]);
+        w.u8(b.peak_hold[i]);
+    }
+    // 2 samples in 3 bytes
+    int k = 0;
+    for (; k + 1 < raw_len; k += 2) {
+        w.u8(raw[k] & 0xff);
+        w.u8(((raw[k] >> 8) & 0x0f) | ((raw[k + 1] & 0x0f) << 4));
+        w.u8((raw[k + 1] >> 4) & 0xff);
+    }
+    if (k < raw_len) {
+        w.u16(raw[k] & 0x0fff);
+    }
+    return w.pos();
+}
+
+bool decode_block(const uint8_t in[], const int len, const int num_ch, block_t& b, uint16_t raw[], const int max_raw_len, int& raw_len)
+{
+    reader r(in, len);
+    if (!r.ok(12 + num_ch * 6)) { return false; }
+    b.seq = r.u32();
+    b.flags = r.u8();
+    b.mode = r.u8();
+    b.switch_pos = r.u32();
+    raw_len = r.u16();
+    for (int i = 0; i < num_ch; i++) {
+        b.code[i] = static_cast<int32_t>(r.u32());
+        b.level[i] = r.u8();
+        b.peak_hold[i] = r.u8();
+    }
+    if (raw_len > max_raw_len || !r.ok((raw_len * 3 + 1) / 2)) { return false; }
+    int k = 0;
+    for (; k + 1 < raw_len; k += 2) {
+        const uint8_t b0 = r.u8();
+        const uint8_t b1 = r.u8();
+        const uint8_t b2 = r.u8();
+        raw[k] = static_cast<uint16_t>(b0 | ((b1 & 0x0f) << 8));
+        raw[k + 1] = static_cast<uint16_t>((b1 >> 4) | (b2 << 4));
+    }
+    if (k < raw_len) {
+        raw[k] = r.u16() & 0x0fff;
+    }
+    return true;
+}
+
+}
+}
@@ -0,0 +1,129 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* trace of raw DMA blocks for deterministic replay
+*
+* A trace is a header frame followed by block frames (wire_frame), both over serial and in a file.
+* The header holds the processing state reset at the start of the trace, and each block holds
+* the raw samples (12 bit packed), the events which affected its processing and the level item
+* produced by the device, so that the replay can check the bit-exactness.
+*/
+namespace trace
+{
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint8_t FRAME_HEADER = 'H';
+    static constexpr uint8_t FRAME_BLOCK  = 'B';
+    static constexpr int MAX_CH = 4;
+    static constexpr int MAX_LEVELS = 64;
+    static constexpr int MAX_MODES = 8;
+    static constexpr int MAX_RANGES = 4;
+
+    // flags of block
+    static constexpr uint8_t FLAG_START      = 1 << 0;  // the processing state is reset at this block (header)
+    static constexpr uint8_t FLAG_GAP        = 1 << 1;  // blocks processed before this block are missing in the trace
+    static constexpr uint8_t FLAG_CALIB      = 1 << 2;  // zero calibration is requested at this block
+    static constexpr uint8_t FLAG_AUTO_RANGE = 1 << 3;  // auto-ranging is enabled at this block
+    static constexpr uint8_t FLAG_SWITCH     = 1 << 4;  // switching of attenuator is notified (switch_pos)
+
+    typedef struct _header_t {
+        uint32_t version;
+        uint32_t seq;            // sequence number of the first block
+        uint32_t sample_rate;    // per channel (after decimation)
+        uint8_t num_ch;
+        uint8_t block_frames;    // frames per block (after decimation)
+        uint8_t oversample;
+        uint8_t calibrating;     // 1: zero calibration in progress
+        uint16_t calib_count;    // blocks counted in zero calibration
+        uint8_t num_modes;
+        uint8_t num_ranges;
+        int32_t zero[MAX_CH];       // zero level (Q8 of raw ADC code)
+        int32_t zero_ref[MAX_CH];   // zero level at calibration
+        int32_t k_att[MAX_MODES];   // ballistics coefficients of each mode (Q30)
+        int32_t k_rel[MAX_MODES];
+        int32_t range_gain[MAX_RANGES];  // compensation of each range of auto-ranging (Q8)
+        uint8_t num_levels;              // 0: no thresholds (dB scale by floating point)
+        uint8_t range_num_levels;
+        uint32_t threshold[MAX_LEVELS];        // dB scale (Q8 of calibrated code)
+        uint32_t range_threshold[MAX_LEVELS];  // dB scale of auto-ranging (Q8 of compensated code)
+    } header_t;
+
+    typedef struct _block_t {
+        uint32_t seq;
+        uint8_t flags;
+        uint8_t mode;            // metering mode applied to the block
+        uint32_t switch_pos;     // sample position of switching (FLAG_SWITCH)
+        int32_t code[MAX_CH];    // level item produced by the device
+        uint8_t level[MAX_CH];
+        uint8_t peak_hold[MAX_CH];
+    } block_t;
+
+    static constexpr int HEADER_SIZE = 22 + MAX_CH * 8 + MAX_MODES * 8 + MAX_RANGES * 4 + MAX_LEVELS * 8;  // max payload of header
+
+    /**
+    * get the max payload size of block
+    *
+    * @param[in] num_ch the number of channels
+    * @param[in] raw_len the number of raw samples
+    * @return the size in bytes
+    */
+    static constexpr int block_size(const int num_ch, const int raw_len)
+    {
+        return 12 + num_ch * 6 + (raw_len * 3 + 1) / 2;
+    }
+
+    /**
+    * serialize header
+    *
+    * @param[in] h the header
+    * @param[out] out the payload (HEADER_SIZE bytes at most)
+    * @return the size of payload
+    */
+    int encode_header(const header_t& h, uint8_t out[]);
+
+    /**
+    * deserialize header
+    *
+    * @param[in] in the payload
+    * @param[in] len the size of payload
+    * @param[out] h the header
+    * @return false if the payload is invalid
+    */
+    bool decode_header(const uint8_t in[], const int len, header_t& h);
+
+    /**
+    * serialize block (raw samples are packed in 12 bit)
+    *
+    * @param[in] b the block
+    * @param[in] num_ch the number of channels of level item
+    * @param[in] raw the raw samples
+    * @param[in] raw_len the number of raw samples
+    * @param[out] out the payload (block_size() bytes at most)
+    * @return the size of payload
+    */
+    int encode_block(const block_t& b, const int num_ch, const uint16_t raw[], const int raw_len, uint8_t out[]);
+
+    /**
+    * deserialize block
+    *
+    * @param[in] in the payload
+    * @param[in] len the size of payload
+    * @param[in] num_ch the number of channels of level item
+    * @param[out] b the block
+    * @param[out] raw the raw samples
+    * @param[in] max_raw_len the capacity of raw
+    * @param[out] raw_len the number of raw samples
+    * @return false if the payload is invalid
+    */
+    bool decode_block(const uint8_t in[], const int len, const int num_ch, block_t& b, uint16_t raw[], const int max_raw_len, int& raw_len);
+}
+}
@@ -0,0 +1,82 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* allocation-free trimmed mean kernel for interleaved multi-channel samples
+*
+* @tparam BUF_LEN the number of interleaved samples in the largest block (all channels)
+* @tparam NUM_CH the number of interleaved channels
+*/
+template <int BUF_LEN, int NUM_CH>
+class trimmed_mean
+{
+public:
+    static_assert(NUM_CH > 0 && BUF_LEN % NUM_CH == 0, "BUF_LEN must be a multiple of NUM_CH");
+
+    static constexpr int LEN   = BUF_LEN / NUM_CH;  // samples per channel
+    static constexpr int START = LEN / 4;           // first sample to average (after sorting)
+    static constexpr int END   = LEN * 3 / 4;       // last sample to average + 1 (after sorting)
+    static constexpr int NUM_AVE = END - START;     // the number of averaged samples
+
+    static_assert(NUM_AVE > 0, "too few samples per channel for trimmed mean");
+
+    /**
+    * the number of averaged samples of a block
+    *
+    * @param[in] len samples per channel (2 ~ LEN)
+    * @return the number of center samples summed up by get_sum()
+    */
+    static constexpr int num_ave(const int len) { return len * 3 / 4 - len / 4; }
+
+    /**
+    * de-interleave the block and sum up the center samples of each channel
+    *
+    * @param[in] buf the interleaved samples
+    * @param[out] sum the sum of NUM_AVE center samples for each channel
+    */
+    static inline void get_sum(const uint16_t buf[BUF_LEN], uint32_t sum[NUM_CH])
+    {
+        get_sum(buf, LEN, sum);
+    }
+
+    /**
+    * de-interleave a block shorter than BUF_LEN and sum up the center samples of each channel
+    *
+    * @param[in] buf the interleaved samples
+    * @param[in] len samples per channel (2 ~ LEN)
+    * @param[out] sum the sum of num_ave(len) center samples for each channel
+    */
+    static inline void get_sum(const uint16_t buf[], const int len, uint32_t sum[NUM_CH])
+    {
+        // de-interleave and insertion sort channel by channel
+        //   (a channel at a time keeps the cost per channel independent of NUM_CH)
+        for (int i = 0; i < NUM_CH; i++) {
+            uint16_t sorted[LEN];
+            for (int j = 0; j < len; j++) {
+                const uint16_t val = buf[j * NUM_CH + i];
+                int k = j;
+                while (k > 0 && sorted[k - 1] > val) {
+                    sorted[k] = sorted[k - 1];
+                    k--;
+                }
+                sorted[k] = val;
+            }
+            // pick center samples and sum up
+            uint32_t s = 0;
+            for (int j = len / 4; j < len * 3 / 4; j++) {
+                s += sorted[j];
+            }
+            sum[i] = s;
+        }
+    }
+};
+}
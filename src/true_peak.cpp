@@ -0,0 +1,62 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include "true_peak.h"
+
+#include <cmath>
+
+namespace level_meter
+{
+
+uint32_t true_peak::_coef[FACTOR][TAPS / 2];
+bool true_peak::_coef_ready = false;
+
+true_peak::true_peak()
+{
+    _init_coef();
+    reset();
+}
+
+void true_peak::reset()
+{
+    for (int i = 0; i < TAPS * 2; i++) {
+        _hist[i] = 0;
+    }
+    _pos = 0;
+}
+
+void true_peak::_init_coef()
+{
+    if (_coef_ready) { return; }
+    // windowed sinc (Hann) low-pass at original Nyquist, unity gain for each phase
+    constexpr int N = FACTOR * TAPS;
+    constexpr double PI = 3.14159265358979323846;
+    int16_t h[FACTOR][TAPS];
+    for (int p = 0; p < FACTOR; p++) {
+        double c[TAPS];
+        double sum = 0.0;
+        for (int k = 0; k < TAPS; k++) {
+            const int n = k * FACTOR + p;
+            const double t = (n - (N - 1) / 2.0) / FACTOR;
+            const double sinc = sin(PI * t) / (PI * t);
+            const double win = 0.5 - 0.5 * cos(2.0 * PI * (n + 0.5) / N);
+            c[k] = sinc * win;
+            sum += c[k];
+        }
+        for (int k = 0; k < TAPS; k++) {
+            // reverse order to multiply with history from oldest sample
+            h[p][TAPS - 1 - k] = static_cast<int16_t>(lround(c[k] / sum * 32767.0));
+        }
+    }
+    for (int p = 0; p < FACTOR; p++) {
+        for (int k = 0; k < TAPS / 2; k++) {
+            _coef[p][k] = static_cast<uint16_t>(h[p][k * 2]) | (static_cast<uint32_t>(static_cast<uint16_t>(h[p][k * 2 + 1])) << 16);
+        }
+    }
+    _coef_ready = true;
+}
+
+}
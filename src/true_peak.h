@@ -0,0 +1,89 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "dsp_util.h"
+
+namespace level_meter
+{
+/**
+* class for ITU-R BS.1770 style true-peak detection by 4x oversampling (single channel)
+*
+* The interpolation is a 48-tap polyphase FIR (4 phases x 12 taps) in Q15
+* computed by dual 16-bit MACs (SMLAD).
+*/
+class true_peak
+{
+public:
+    static constexpr int FACTOR = 4;   // oversampling factor
+    static constexpr int TAPS   = 12;  // taps per phase
+    static constexpr int SHIFT  = 3;   // calibrated code (12bit) to int16 sample
+
+    /**
+    * constructor of true_peak
+    */
+    true_peak();
+
+    /**
+    * reset filter history
+    */
+    void reset();
+
+    /**
+    * process interleaved samples of the channel
+    *
+    * @param[in] samples the pointer to the first sample of the channel
+    * @param[in] stride the interval of the samples of the channel
+    * @param[in] len the number of samples of the channel
+    * @param[in] gain the calibration gain (Q16)
+    * @param[in] ofs the calibration offset in ADC code
+    * @param[in] over_th the threshold of over in calibrated ADC code
+    * @param[out] num_over the number of input samples whose oversampled values reach over_th
+    * @return the maximum absolute oversampled value in calibrated ADC code
+    */
+    inline int32_t process(const uint16_t* samples, const int stride, const int len, const int32_t gain, const int32_t ofs,
+                           const int32_t over_th, uint32_t& num_over)
+    {
+        const int32_t th = over_th << SHIFT;
+        int32_t peak = 0;
+        uint32_t n = 0;
+        for (int j = 0; j < len; j++) {
+            const int16_t x = static_cast<int16_t>(dsp::calib(samples[j * stride], gain, ofs) << SHIFT);
+            _pos = (_pos == TAPS - 1) ? 0 : _pos + 1;
+            _hist[_pos] = x;
+            _hist[_pos + TAPS] = x;
+            // _hist[_pos + 1] ~ _hist[_pos + TAPS] holds oldest to newest
+            const int16_t* h = &_hist[_pos + 1];
+            int32_t smpl_peak = 0;
+            for (int p = 0; p < FACTOR; p++) {
+                const uint32_t* c = _coef[p];
+                int32_t acc = 0;
+                for (int k = 0; k < TAPS / 2; k++) {
+                    acc = dsp::smlad(dsp::load_pair(&h[k * 2]), c[k], acc);
+                }
+                acc >>= 15;
+                if (acc < 0) { acc = -acc; }
+                if (acc > smpl_peak) { smpl_peak = acc; }
+            }
+            if (smpl_peak >= th) { n++; }
+            if (smpl_peak > peak) { peak = smpl_peak; }
+        }
+        num_over = n;
+        return peak >> SHIFT;
+    }
+
+protected:
+    static uint32_t _coef[FACTOR][TAPS / 2];  // packed Q15 pairs (oldest sample first)
+    static bool _coef_ready;
+    int16_t _hist[TAPS * 2];  // doubled history to read TAPS samples contiguously
+    int _pos;
+
+    static void _init_coef();
+};
+}
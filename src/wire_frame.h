@@ -0,0 +1,142 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace level_meter
+{
+/**
+* framing of binary records sent over serial together with text output
+*
+* frame: SYNC0 SYNC1 type len(LE16) payload[len] crc(LE16)
+*   crc is CRC-16/CCITT-FALSE of type, len and payload
+*   SYNC0 is not ASCII, so that the receiver can skip the text between frames
+*/
+namespace wire_frame
+{
+    static constexpr uint8_t SYNC0 = 0xa5;
+    static constexpr uint8_t SYNC1 = 0x5a;
+    static constexpr int HEADER_LEN = 5;    // SYNC0, SYNC1, type and len
+    static constexpr int OVERHEAD = HEADER_LEN + 2;
+    static constexpr int MAX_PAYLOAD = 4096;
+
+    /**
+    * update CRC-16/CCITT-FALSE
+    *
+    * @param[in] data the data
+    * @param[in] len the length of data
+    * @param[in] crc the CRC of preceding data
+    * @return the CRC
+    */
+    static inline uint16_t crc16(const uint8_t data[], const int len, uint16_t crc = 0xffff)
+    {
+        for (int i = 0; i < len; i++) {
+            crc ^= static_cast<uint16_t>(data[i]) << 8;
+            for (int b = 0; b < 8; b++) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    /**
+    * write the header of a frame (for the payload sent separately, followed by CRC of crc16() from the header)
+    *
+    * @param[out] frame the buffer (HEADER_LEN bytes)
+    * @param[in] type the type of frame
+    * @param[in] len the length of payload (up to MAX_PAYLOAD)
+    */
+    static inline void begin(uint8_t frame[], const uint8_t type, const int len)
+    {
+        frame[0] = SYNC0;
+        frame[1] = SYNC1;
+        frame[2] = type;
+        frame[3] = static_cast<uint8_t>(len & 0xff);
+        frame[4] = static_cast<uint8_t>(len >> 8);
+    }
+
+    /**
+    * build a frame in place around the payload
+    *
+    * @param[in,out] frame the buffer whose payload is written at &frame[HEADER_LEN] (len + OVERHEAD bytes)
+    * @param[in] type the type of frame
+    * @param[in] len the length of payload (up to MAX_PAYLOAD)
+    * @return the length of frame
+    */
+    static inline int seal(uint8_t frame[], const uint8_t type, const int len)
+    {
+        begin(frame, type, len);
+        const uint16_t crc = crc16(&frame[2], len + 3);
+        frame[HEADER_LEN + len] = static_cast<uint8_t>(crc & 0xff);
+        frame[HEADER_LEN + len + 1] = static_cast<uint8_t>(crc >> 8);
+        return len + OVERHEAD;
+    }
+
+    /**
+    * streaming decoder of frames (the bytes out of frames are left to the caller)
+    */
+    class decoder
+    {
+    public:
+        decoder() : _pos(0), _len(0), _num_errors(0) {}
+
+        /**
+        * feed a byte
+        *
+        * @param[in] c the received byte
+        * @param[out] is_text true if the byte is out of frames
+        * @return true if a frame is completed (type(), payload() and len() are valid until next push)
+        */
+        bool push(const uint8_t c, bool& is_text)
+        {
+            is_text = false;
+            if (_pos == 0) {
+                if (c == SYNC0) {
+                    _buf[_pos++] = c;
+                } else {
+                    is_text = true;
+                }
+                return false;
+            }
+            if (_pos == 1 && c != SYNC1) {
+                _pos = 0;
+                return push(c, is_text);
+            }
+            _buf[_pos++] = c;
+            if (_pos == HEADER_LEN) {
+                _len = _buf[3] | (_buf[4] << 8);
+                if (_len > MAX_PAYLOAD) {
+                    _num_errors++;
+                    _pos = 0;
+                }
+                return false;
+            }
+            if (_pos < _len + OVERHEAD) { return false; }
+            _pos = 0;
+            const uint16_t crc = crc16(&_buf[2], _len + 3);
+            if ((_buf[HEADER_LEN + _len] | (_buf[HEADER_LEN + _len + 1] << 8)) != crc) {
+                _num_errors++;
+                return false;
+            }
+            return true;
+        }
+
+        uint8_t type() const { return _buf[2]; }
+        const uint8_t* payload() const { return &_buf[HEADER_LEN]; }
+        int len() const { return _len; }
+        const uint8_t* frame() const { return _buf; }  // the whole frame (len() + OVERHEAD bytes)
+        uint32_t get_num_errors() const { return _num_errors; }
+
+    protected:
+        uint8_t _buf[MAX_PAYLOAD + OVERHEAD];
+        int _pos;
+        int _len;
+        uint32_t _num_errors;  // frames with CRC error or invalid length
+    };
+}
+}